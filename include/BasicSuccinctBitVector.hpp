@@ -0,0 +1,416 @@
+/*-----------------------------------------------------------------------------
+ *  BasicSuccinctBitVector.hpp - A rank/select dictionary with policies
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __BASICSUCCINCTBITVECTOR_HPP__
+#define __BASICSUCCINCTBITVECTOR_HPP__
+
+#include <memory>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * Popcount policies count ones in a block by count(). The default
+ * one is popcount64(), chosen by __USE_SSE_POPCNT__. Layouts use
+ * the policy for rank, and for select in a superblock.
+ */
+class DefaultPopcount {
+ public:
+  static uint64_t count(block_t b) {
+    return popcount64(b);
+  }
+};
+
+class BuiltinPopcount {
+ public:
+  static uint64_t count(block_t b) {
+    return __builtin_popcountll(b);
+  }
+};
+
+/* Count ones in parallel in a block with no table nor instruction */
+class SwarPopcount {
+ public:
+  static uint64_t count(block_t b) {
+    b = b - ((b >> 1) & 0x5555555555555555ULL);
+    b = (b & 0x3333333333333333ULL) + ((b >> 2) & 0x3333333333333333ULL);
+    b = (b + (b >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (b * 0x0101010101010101ULL) >> 56;
+  }
+};
+
+/* selectPos() with the bytes of blk counted by a popcount policy P */
+template<class P>
+static inline uint64_t policy_select(block_t blk, uint64_t r) {
+  uint64_t nblock = 0;
+  for (; nblock < 8; nblock++) {
+    uint64_t cnt = P::count((blk >> nblock * 8) & 0xff);
+    if (r < cnt)
+      break;
+    r -= cnt;
+  }
+
+  return nblock * 8 +
+      selectPos_[(r << 8) + ((blk >> (nblock * 8)) & 0xff)];
+}
+
+/*
+ * Layout policies keep the bits with the number of ones before
+ * each superblock of SB_SZ bits. Index<P, A> is a layout with a
+ * popcount policy P and an allocator A, and select(i, rem, bit)
+ * returns the offset of the rem-th bit in the i-th superblock.
+ */
+
+/* rBlocks of SuccinctBitVector, that is, bits and counts together */
+class InterleavedLayout {
+ public:
+  template<class P, class A>
+  class Index {
+   public:
+    static const size_t SB_SZ = PRESUM_SZ;
+
+    /* Lay out size bits in B, and return the number of ones */
+    uint64_t build(const block_t *B, uint64_t bsize, uint64_t size) {
+      size_t bnum = size / PRESUM_SZ + 1;
+      rblk_.resize(bnum);
+
+      uint64_t r = 0;
+      for (size_t i = 0; i < bnum; i++) {
+        rBlock& rblk = rblk_[i];
+        rblk.b0 = (2 * i < bsize)? B[2 * i] : 0;
+        rblk.b1 = (2 * i + 1 < bsize)? B[2 * i + 1] : 0;
+        rblk.rk = r;
+        rblk.b0sum = P::count(rblk.b0);
+        r += rblk.b0sum + P::count(rblk.b1);
+      }
+
+      return r;
+    }
+
+    bool lookup(uint64_t pos) const {
+      const rBlock& rblk = rblk_[pos / PRESUM_SZ];
+      block_t blk = (pos & BSIZE)? rblk.b1 : rblk.b0;
+      return (blk >> (pos % BSIZE)) & 1;
+    }
+
+    /* The number of ones in [0, pos) */
+    uint64_t rank1(uint64_t pos) const {
+      const rBlock& rblk = rblk_[pos / PRESUM_SZ];
+
+      uint64_t mask = (uint64_t(1) << (pos % BSIZE)) - 1;
+      uint64_t m = (pos & BSIZE)? uint64_t(-1) : 0;
+      return rblk.rk + P::count(rblk.b0 & (mask | m)) +
+          P::count(rblk.b1 & (mask & m));
+    }
+
+    uint64_t cumltv(uint64_t i, uint8_t bit) const {
+      return rblock_cumltv(rblk_[i], i, bit);
+    }
+
+    uint64_t select(uint64_t i, uint64_t rem, uint8_t bit) const {
+      const rBlock& rblk = rblk_[i];
+      uint64_t b0sum = (bit)? rblk.b0sum : BSIZE - rblk.b0sum;
+
+      if (b0sum > rem)
+        return policy_select<P>((bit)? rblk.b0 : ~rblk.b0, rem);
+      return BSIZE +
+          policy_select<P>((bit)? rblk.b1 : ~rblk.b1, rem - b0sum);
+    }
+
+    uint64_t sb_num() const {
+      return rblk_.size();
+    }
+
+    uint64_t space() const {
+      return rblk_.size() * sizeof(rBlock);
+    }
+
+   private:
+    std::vector<rBlock, typename std::allocator_traits<A>::
+        template rebind_alloc<rBlock> > rblk_;
+  }; /* Index */
+}; /* InterleavedLayout */
+
+/* Blocks and counts in separate arrays, with SB bits per count */
+template<size_t SB = 4 * BSIZE>
+class FlatLayout {
+ public:
+  template<class P, class A>
+  class Index {
+   public:
+    static const size_t SB_SZ = SB;
+    static const size_t SB_BNUM = SB / BSIZE;
+
+    static_assert(SB % BSIZE == 0 && SB != 0, "SB must be blocks");
+
+    uint64_t build(const block_t *B, uint64_t bsize, uint64_t size) {
+      size_t bnum = size / SB + 1;
+      B_.assign(bnum * SB_BNUM, 0);
+      std::copy(B, B + bsize, B_.begin());
+      rk_.resize(bnum);
+
+      uint64_t r = 0;
+      for (size_t i = 0; i < bnum; i++) {
+        rk_[i] = r;
+        for (size_t w = 0; w < SB_BNUM; w++)
+          r += P::count(B_[i * SB_BNUM + w]);
+      }
+
+      return r;
+    }
+
+    bool lookup(uint64_t pos) const {
+      return (B_[pos / BSIZE] >> (pos % BSIZE)) & 1;
+    }
+
+    uint64_t rank1(uint64_t pos) const {
+      uint64_t r = rk_[pos / SB];
+      for (size_t w = pos / SB * SB_BNUM; w < pos / BSIZE; w++)
+        r += P::count(B_[w]);
+      if (pos % BSIZE != 0)
+        r += P::count(B_[pos / BSIZE] &
+                      ((uint64_t(1) << (pos % BSIZE)) - 1));
+      return r;
+    }
+
+    uint64_t cumltv(uint64_t i, uint8_t bit) const {
+      return (bit)? rk_[i] : i * SB - rk_[i];
+    }
+
+    uint64_t select(uint64_t i, uint64_t rem, uint8_t bit) const {
+      for (size_t w = 0;; w++) {
+        block_t blk = B_[i * SB_BNUM + w];
+        if (!bit)
+          blk = ~blk;
+
+        uint64_t n = P::count(blk);
+        if (rem < n)
+          return w * BSIZE + policy_select<P>(blk, rem);
+        rem -= n;
+      }
+    }
+
+    uint64_t sb_num() const {
+      return rk_.size();
+    }
+
+    uint64_t space() const {
+      return B_.size() * sizeof(block_t) + rk_.size() * sizeof(uint64_t);
+    }
+
+   private:
+    std::vector<block_t, A> B_;
+    std::vector<uint64_t, typename std::allocator_traits<A>::
+        template rebind_alloc<uint64_t> > rk_;
+  }; /* Index */
+}; /* FlatLayout */
+
+/* The last superblock in [lo, hi] whose cumulative count <= pos */
+template<class L>
+static inline uint64_t layout_search(const L& l, uint64_t lo, uint64_t hi,
+                                     uint64_t pos, uint8_t bit) {
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo + 1) / 2;
+    if (l.cumltv(mid, bit) <= pos)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  return lo;
+}
+
+/*
+ * Select policies find the superblock of a bit by find(). Index<L, A>
+ * is a select dictionary over a layout L with an allocator A.
+ */
+
+/* Sample the superblock of every S-th bit as SuccinctSelect does */
+template<size_t S = SELECT_SAMPLE_SZ>
+class SampledSelect {
+ public:
+  template<class L, class A>
+  class Index {
+   public:
+    static_assert(S != 0, "S must not be zero");
+
+    void build(const L& l, uint64_t n, uint8_t bit) {
+      uint64_t bnum = l.sb_num();
+      hints_.clear();
+      hints_.reserve(n / S + 2);
+
+      uint64_t i = 0;
+      for (uint64_t pos = 0; pos < n; pos += S) {
+        while (i + 1 < bnum && l.cumltv(i + 1, bit) <= pos)
+          i++;
+        hints_.push_back(i);
+      }
+
+      /* A sentinel to bound the last search */
+      hints_.push_back(bnum - 1);
+    }
+
+    uint64_t find(const L& l, uint64_t pos, uint8_t bit) const {
+      return layout_search(l, hints_[pos / S], hints_[pos / S + 1],
+                           pos, bit);
+    }
+
+    uint64_t space() const {
+      return hints_.size() * sizeof(uint64_t);
+    }
+
+   private:
+    std::vector<uint64_t, typename std::allocator_traits<A>::
+        template rebind_alloc<uint64_t> > hints_;
+  }; /* Index */
+}; /* SampledSelect */
+
+/* Search all the superblocks, and keep nothing */
+class BinarySearchSelect {
+ public:
+  template<class L, class A>
+  class Index {
+   public:
+    void build(const L&, uint64_t, uint8_t) {}
+
+    uint64_t find(const L& l, uint64_t pos, uint8_t bit) const {
+      return layout_search(l, 0, l.sb_num() - 1, pos, bit);
+    }
+
+    uint64_t space() const {
+      return 0;
+    }
+  }; /* Index */
+}; /* BinarySearchSelect */
+
+/*
+ * BasicSuccinctBitVector is a rank/select dictionary whose layout,
+ * select, popcount and allocator are given as policies, so their
+ * code is inlined into the queries at compile time. The default
+ * policies lay out bits as SuccinctBitVector does. Bits set before
+ * build() are moved into the layout, so set_bit() is not allowed
+ * after that.
+ */
+template<class Layout = InterleavedLayout,
+         class SelectPolicy = SampledSelect<>,
+         class PopcountPolicy = DefaultPopcount,
+         class Alloc = std::allocator<block_t> >
+class BasicSuccinctBitVector {
+ public:
+  typedef typename Layout::template Index<PopcountPolicy, Alloc> LayoutIndex;
+  typedef typename SelectPolicy::template Index<LayoutIndex, Alloc>
+      SelectIndex;
+
+  BasicSuccinctBitVector() : size_(0), none_(0) {}
+  ~BasicSuccinctBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    if (size == 0)
+      throw "Invalid input: size";
+
+    size_ = size;
+    B_.assign((size + BSIZE - 1) / BSIZE, 0);
+  }
+
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (B_.empty())
+      throw "Not initialized yet: B_";
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    block_t mask = uint64_t(1) << (pos % BSIZE);
+    if (bit)
+      B_[pos / BSIZE] |= mask;
+    else
+      B_[pos / BSIZE] &= ~mask;
+  }
+
+  void build() {
+    if (B_.empty())
+      throw "Not initialized yet: B_";
+
+    none_ = layout_.build(B_.data(), B_.size(), size_);
+    st_[0].build(layout_, size_ - none_, 0);
+    st_[1].build(layout_, none_, 1);
+
+    std::vector<block_t, Alloc>().swap(B_);
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    return layout_.lookup(pos);
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t r = layout_.rank1(pos + 1);
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? none_ : size_ - none_))
+      throw "Invalid input: pos";
+
+    uint64_t i = st_[bit].find(layout_, pos, bit);
+    return i * LayoutIndex::SB_SZ +
+        layout_.select(i, pos - layout_.cumltv(i, bit), bit);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  /* The size of the dictionaries in bytes */
+  uint64_t space() const {
+    return layout_.space() + st_[0].space() + st_[1].space();
+  }
+
+ private:
+  uint64_t  size_;
+  uint64_t  none_;
+
+  /* Bits kept until build() */
+  std::vector<block_t, Alloc> B_;
+
+  LayoutIndex layout_;
+  SelectIndex st_[2];
+}; /* BasicSuccinctBitVector */
+
+/*
+ * The same layout and select as SuccinctBitVector, so they answer
+ * queries in the same way. This is a separate type, and not
+ * interchangeable with SuccinctBitVector: it has no serialization,
+ * append(), cursors, patterns nor updates after build().
+ */
+typedef BasicSuccinctBitVector<> DefaultSuccinctBitVector;
+
+} /* dense */
+} /* succinct */
+
+#endif /* __BASICSUCCINCTBITVECTOR_HPP__ */
@@ -0,0 +1,320 @@
+/*-----------------------------------------------------------------------------
+ *  DeltaSuccinctBitVector.hpp - A rank/select dictionary with a delta buffer
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __DELTASUCCINCTBITVECTOR_HPP__
+#define __DELTASUCCINCTBITVECTOR_HPP__
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iterator>
+#include <algorithm>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+/* The number of updated bits to start a merge by default */
+static const size_t DELTA_MERGE_SZ = 1024;
+
+/*
+ * DeltaSuccinctBitVector keeps the bits updated after build() in a
+ * sorted delta buffer over a built SuccinctBitVector. The positions
+ * whose bits differ from the base are kept, with those set to one
+ * in another array, so rank adds the difference of their counts
+ * before a position to the base rank. Select binary-searches the
+ * delta for the gap holding the bit, and selects it in the base.
+ * When the delta reaches merge_sz positions, a thread copies the
+ * base and flips them in the copy by SuccinctBitVector::flip_bits(),
+ * which only counts the updated rBlocks again. Queries and updates
+ * go on with the current base and delta in the meantime, and the
+ * copy is swapped in for the base at the first update after the
+ * merge or by wait_merge(). Only this background path copies the
+ * base, which costs O(n) time and space in the thread per merge, so
+ * merge_sz should grow with the length. merge() flips the delta in
+ * place in the calling thread instead, with no copy unless the base
+ * is shared with another vector.
+ */
+class DeltaSuccinctBitVector {
+ public:
+  explicit DeltaSuccinctBitVector(size_t merge_sz = DELTA_MERGE_SZ) :
+      merge_sz_(merge_sz), built_(false), done_(false) {
+    if (merge_sz == 0)
+      throw "Invalid input: merge_sz";
+  }
+  explicit DeltaSuccinctBitVector(const SuccinctBitVector& sbv,
+                                  size_t merge_sz = DELTA_MERGE_SZ) :
+      merge_sz_(merge_sz), built_(true), base_(sbv), done_(false) {
+    if (merge_sz == 0)
+      throw "Invalid input: merge_sz";
+
+    /* Throw if sbv is not built */
+    base_.select_sample();
+  }
+  ~DeltaSuccinctBitVector() throw() {
+    if (merger_.joinable())
+      merger_.join();
+  }
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    wait_merge();
+    base_ = SuccinctBitVector();
+    base_.init(size);
+    delta_.clear();
+    ones_.clear();
+    built_ = false;
+  }
+
+  /* Bits are set in the base before build(), or in the delta after it */
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (!built_) {
+      base_.set_bit(pos, bit);
+      return;
+    }
+
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (lookup(pos) == (bit != 0))
+      return;
+
+    if (done_)
+      finish_merge();
+
+    /* A bit back to the base leaves the delta */
+    std::vector<uint64_t>::iterator it =
+        std::lower_bound(delta_.begin(), delta_.end(), pos);
+    bool back = it != delta_.end() && *it == pos;
+    if (back)
+      delta_.erase(it);
+    else
+      delta_.insert(it, pos);
+
+    it = std::lower_bound(ones_.begin(), ones_.end(), pos);
+    if (bit && !back)
+      ones_.insert(it, pos);
+    else if (!bit && back)
+      ones_.erase(it);
+
+    if (delta_.size() >= merge_sz_ && !merger_.joinable())
+      start_merge();
+  }
+
+  void set(uint64_t pos) {
+    set_bit(pos, 1);
+  }
+
+  void clear(uint64_t pos) {
+    set_bit(pos, 0);
+  }
+
+  void flip(uint64_t pos) {
+    set_bit(pos, !lookup(pos));
+  }
+
+  void build() {
+    if (built_)
+      return;
+
+    base_.build();
+    built_ = true;
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (!built_)
+      return base_.lookup(pos);
+
+    return base_.lookup(pos) ^ in_delta(pos);
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (!built_)
+      throw "Not built yet: base_";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t r = base_.rank(pos, 1) + corr(pos + 1);
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (!built_)
+      throw "Not built yet: base_";
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? get_none() : length() - get_none()))
+      throw "Invalid input: pos";
+
+    /* The last delta position with at most pos bits before it */
+    size_t lo = 0;
+    size_t hi = delta_.size();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (count_before(mid, bit) <= pos)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if (lo == 0)
+      return base_.select(pos, bit);
+
+    /* Skip the bits up to the delta position in the base */
+    uint64_t d = delta_[lo - 1];
+    uint64_t n = count_before(lo - 1, bit);
+    bool cur = in_ones(d);
+    if (cur == (bit != 0) && n == pos)
+      return d;
+
+    uint64_t r = pos - n - (cur == (bit != 0));
+    return base_.select(base_.rank(d, bit) + r, bit);
+  }
+
+  uint64_t length() const {
+    return base_.length();
+  }
+
+  uint64_t get_none() const {
+    return base_.get_none() + 2 * ones_.size() - delta_.size();
+  }
+
+  /* The number of the positions in the delta */
+  size_t delta_num() const {
+    return delta_.size();
+  }
+
+  /* A merge is running, or its result is not taken yet */
+  bool merging() const {
+    return merger_.joinable();
+  }
+
+  /*
+   * Finish a running merge, and flip the delta into the base in
+   * this thread. Only the dirty rBlocks are counted again, though
+   * the counts of all the following rBlocks are still shifted.
+   */
+  void merge() {
+    if (!built_)
+      throw "Not built yet: base_";
+
+    finish_merge();
+    if (delta_.empty())
+      return;
+
+    base_.flip_bits(delta_.data(), delta_.size());
+    delta_.clear();
+    ones_.clear();
+  }
+
+  /* Wait for a running merge, and replace the base with its result */
+  void wait_merge() {
+    finish_merge();
+  }
+
+  /* Merge the delta, and return the base */
+  const SuccinctBitVector& freeze() {
+    merge();
+    return base_;
+  }
+
+  /* The size of the delta in bytes */
+  uint64_t space() const {
+    return (delta_.capacity() + ones_.capacity()) * sizeof(uint64_t);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  bool in_delta(uint64_t pos) const {
+    return std::binary_search(delta_.begin(), delta_.end(), pos);
+  }
+
+  bool in_ones(uint64_t pos) const {
+    return std::binary_search(ones_.begin(), ones_.end(), pos);
+  }
+
+  /* The difference from the base in the ones in [0, pos) */
+  int64_t corr(uint64_t pos) const {
+    int64_t nd = std::lower_bound(delta_.begin(), delta_.end(), pos) -
+        delta_.begin();
+    int64_t no = std::lower_bound(ones_.begin(), ones_.end(), pos) -
+        ones_.begin();
+    return 2 * no - nd;
+  }
+
+  /* The number of bits in [0, delta_[i]) */
+  uint64_t count_before(size_t i, uint8_t bit) const {
+    uint64_t d = delta_[i];
+    uint64_t r = ((d)? base_.rank(d - 1, 1) : 0) + corr(d);
+    return (bit)? r : d - r;
+  }
+
+  void start_merge() {
+    flipped_ = delta_;
+    done_ = false;
+    merger_ = std::thread(&DeltaSuccinctBitVector::run_merge, this);
+  }
+
+  /* base_ is only read until the merge is finished */
+  void run_merge() {
+    merged_ = base_;
+    merged_.flip_bits(flipped_.data(), flipped_.size());
+    done_ = true;
+  }
+
+  /*
+   * The flipped positions leave the delta, and the others are
+   * added to it for the new base.
+   */
+  void finish_merge() {
+    if (!merger_.joinable())
+      return;
+
+    merger_.join();
+    base_.swap(merged_);
+    merged_ = SuccinctBitVector();
+
+    std::vector<uint64_t> delta;
+    std::set_symmetric_difference(delta_.begin(), delta_.end(),
+                                  flipped_.begin(), flipped_.end(),
+                                  std::back_inserter(delta));
+    std::vector<uint64_t>().swap(flipped_);
+
+    std::vector<uint64_t> ones;
+    for (size_t i = 0; i < delta.size(); i++) {
+      if (!base_.lookup(delta[i]))
+        ones.push_back(delta[i]);
+    }
+
+    delta_.swap(delta);
+    ones_.swap(ones);
+  }
+
+  size_t    merge_sz_;
+  bool      built_;
+
+  SuccinctBitVector     base_;
+
+  /* Positions whose bits differ from base_, and those set to one */
+  std::vector<uint64_t> delta_;
+  std::vector<uint64_t> ones_;
+
+  /* A copy of base_ and the positions flipped in it by merger_ */
+  SuccinctBitVector     merged_;
+  std::vector<uint64_t> flipped_;
+  std::atomic<bool>     done_;
+  std::thread           merger_;
+}; /* DeltaSuccinctBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __DELTASUCCINCTBITVECTOR_HPP__ */
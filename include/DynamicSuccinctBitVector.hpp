@@ -0,0 +1,607 @@
+/*-----------------------------------------------------------------------------
+ *  DynamicSuccinctBitVector.hpp - A rank/select dictionary with insertions
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __DYNAMICSUCCINCTBITVECTOR_HPP__
+#define __DYNAMICSUCCINCTBITVECTOR_HPP__
+
+#include <algorithm>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+static const size_t DYNAMIC_LEAF_SZ = 2048;
+static const size_t DYNAMIC_LEAF_BNUM = DYNAMIC_LEAF_SZ / BSIZE;
+static const size_t DYNAMIC_FANOUT = 16;
+
+/* A leaf of bits, whose bits beyond size are zero */
+typedef struct {
+  uint64_t  size;
+  uint64_t  ones;
+  block_t   B[DYNAMIC_LEAF_BNUM];
+} dLeaf;
+
+/* An internal node with the bits and ones under each child */
+typedef struct {
+  uint64_t  num;
+  uint64_t  size[DYNAMIC_FANOUT];
+  uint64_t  ones[DYNAMIC_FANOUT];
+  uint64_t  child[DYNAMIC_FANOUT];
+} dNode;
+
+/*
+ * DynamicSuccinctBitVector is a B+tree of leaves with up to
+ * DYNAMIC_LEAF_SZ bits and internal nodes with up to DYNAMIC_FANOUT
+ * children, so bits can be inserted and erased at any position.
+ * Nodes keep the bits and ones under each child in arrays scanned
+ * linearly, and leaves are scanned by popcount64() and selectPos(),
+ * so all the operations run in O(log n). A full leaf or node is
+ * split in halves, and one under a quarter is merged with or
+ * refilled from a sibling. Leaves and nodes are kept in arrays and
+ * referred by indices, so a vector is copied by value.
+ */
+class DynamicSuccinctBitVector {
+ public:
+  DynamicSuccinctBitVector() : size_(0), none_(0), height_(0), root_(0) {
+    clear();
+  }
+  explicit DynamicSuccinctBitVector(const SuccinctBitVector& sbv) :
+      size_(0), none_(0), height_(0), root_(0) {
+    build(sbv);
+  }
+  ~DynamicSuccinctBitVector() throw() {}
+
+  void clear() {
+    leaves_.assign(1, dLeaf());
+    nodes_.clear();
+    lfree_.clear();
+    nfree_.clear();
+    size_ = none_ = height_ = root_ = 0;
+  }
+
+  /* Fill leaves with the bits of a built vector, and nodes over them */
+  void build(const SuccinctBitVector& sbv) {
+    if (!sbv.rk_)
+      throw "Not built yet: rk_";
+
+    clear();
+    leaves_.clear();
+
+    uint64_t len = sbv.length();
+    std::vector<uint64_t> level;
+    for (uint64_t off = 0; off < len; off += DYNAMIC_LEAF_SZ) {
+      dLeaf l = dLeaf();
+      l.size = std::min(DYNAMIC_LEAF_SZ, len - off);
+      for (size_t w = 0; w < (l.size + BSIZE - 1) / BSIZE; w++) {
+        l.B[w] = sbv.bv_.get_block(off / BSIZE + w);
+        l.ones += popcount64(l.B[w]);
+      }
+
+      level.push_back(leaves_.size());
+      leaves_.push_back(l);
+    }
+
+    while (level.size() > 1) {
+      std::vector<uint64_t> upper;
+      for (size_t i = 0; i < level.size(); i += DYNAMIC_FANOUT) {
+        dNode n = dNode();
+        for (size_t j = i; j < std::min(i + DYNAMIC_FANOUT, level.size());
+             j++) {
+          n.child[n.num] = level[j];
+          summary(level[j], height_, n.size[n.num], n.ones[n.num]);
+          n.num++;
+        }
+
+        upper.push_back(nodes_.size());
+        nodes_.push_back(n);
+      }
+
+      level.swap(upper);
+      height_++;
+    }
+
+    root_ = level[0];
+    size_ = len;
+    none_ = sbv.get_none();
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    uint64_t r = 0;
+    const dLeaf& l = find_leaf(pos, r);
+    return (l.B[pos / BSIZE] >> (pos % BSIZE)) & 1;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t p = pos;
+    uint64_t r = 0;
+    const dLeaf& l = find_leaf(p, r);
+
+    for (size_t w = 0; w < p / BSIZE; w++)
+      r += popcount64(l.B[w]);
+    if (p % BSIZE != BSIZE - 1)
+      r += popcount64(l.B[p / BSIZE] &
+                      ((uint64_t(1) << (p % BSIZE + 1)) - 1));
+    else
+      r += popcount64(l.B[p / BSIZE]);
+
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? none_ : size_ - none_))
+      throw "Invalid input: pos";
+
+    uint64_t base = 0;
+    uint64_t idx = root_;
+    for (uint64_t lv = height_; lv > 0; lv--) {
+      const dNode& n = nodes_[idx];
+
+      size_t i = 0;
+      for (;; i++) {
+        uint64_t c = (bit)? n.ones[i] : n.size[i] - n.ones[i];
+        if (pos < c)
+          break;
+        pos -= c;
+        base += n.size[i];
+      }
+
+      idx = n.child[i];
+    }
+
+    const dLeaf& l = leaves_[idx];
+    for (size_t w = 0;; w++) {
+      block_t blk = (bit)? l.B[w] : ~l.B[w];
+      uint64_t c = popcount64(blk);
+      if (pos < c)
+        return base + w * BSIZE + selectPos(blk, pos);
+      pos -= c;
+    }
+  }
+
+  /* Insert bit before pos, or at the end if pos is length() */
+  void insert(uint64_t pos, uint8_t bit) {
+    if (pos > size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t s = insert(root_, height_, pos, bit);
+    if (s != NIL) {
+      dNode n = dNode();
+      n.num = 2;
+      n.child[0] = root_;
+      n.child[1] = s;
+      summary(root_, height_, n.size[0], n.ones[0]);
+      summary(s, height_, n.size[1], n.ones[1]);
+
+      root_ = alloc_node();
+      nodes_[root_] = n;
+      height_++;
+    }
+
+    size_++;
+    none_ += bit;
+  }
+
+  /* Erase the bit at pos, and shift the following bits */
+  void erase(uint64_t pos) {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    uint8_t bit = erase(root_, height_, pos);
+    size_--;
+    none_ -= bit;
+
+    /* A root with a single child is dropped */
+    while (height_ > 0 && nodes_[root_].num == 1) {
+      nfree_.push_back(root_);
+      root_ = nodes_[root_].child[0];
+      height_--;
+    }
+  }
+
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (lookup(pos) == (bit != 0))
+      return;
+
+    uint64_t idx = root_;
+    for (uint64_t lv = height_; lv > 0; lv--) {
+      dNode& n = nodes_[idx];
+
+      size_t i = 0;
+      while (pos >= n.size[i])
+        pos -= n.size[i++];
+
+      if (bit)
+        n.ones[i]++;
+      else
+        n.ones[i]--;
+      idx = n.child[i];
+    }
+
+    dLeaf& l = leaves_[idx];
+    l.B[pos / BSIZE] ^= uint64_t(1) << (pos % BSIZE);
+    if (bit)
+      l.ones++, none_++;
+    else
+      l.ones--, none_--;
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  /* Write the bits into sbv, and build it for static queries */
+  void freeze(SuccinctBitVector& sbv) const {
+    if (size_ == 0)
+      throw "Invalid input: size";
+
+    sbv = SuccinctBitVector();
+    sbv.init(size_);
+
+    uint64_t off = 0;
+    freeze(root_, height_, sbv, off);
+    sbv.build();
+  }
+
+  /* The size of the leaves and the nodes in bytes */
+  uint64_t space() const {
+    return leaves_.size() * sizeof(dLeaf) + nodes_.size() * sizeof(dNode);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  static const uint64_t NIL = UINT64_MAX;
+
+  /* Find the leaf of pos, with pos in it and the ones before it */
+  const dLeaf& find_leaf(uint64_t& pos, uint64_t& r) const {
+    uint64_t idx = root_;
+    for (uint64_t lv = height_; lv > 0; lv--) {
+      const dNode& n = nodes_[idx];
+
+      size_t i = 0;
+      while (pos >= n.size[i]) {
+        pos -= n.size[i];
+        r += n.ones[i++];
+      }
+
+      idx = n.child[i];
+    }
+
+    return leaves_[idx];
+  }
+
+  /* The bits and ones under a leaf (lv == 0) or a node */
+  void summary(uint64_t idx, uint64_t lv,
+               uint64_t& size, uint64_t& ones) const {
+    if (lv == 0) {
+      size = leaves_[idx].size;
+      ones = leaves_[idx].ones;
+      return;
+    }
+
+    const dNode& n = nodes_[idx];
+    size = ones = 0;
+    for (size_t i = 0; i < n.num; i++) {
+      size += n.size[i];
+      ones += n.ones[i];
+    }
+  }
+
+  uint64_t alloc_leaf() {
+    if (lfree_.empty()) {
+      leaves_.push_back(dLeaf());
+      return leaves_.size() - 1;
+    }
+
+    uint64_t idx = lfree_.back();
+    lfree_.pop_back();
+    leaves_[idx] = dLeaf();
+    return idx;
+  }
+
+  uint64_t alloc_node() {
+    if (nfree_.empty()) {
+      nodes_.push_back(dNode());
+      return nodes_.size() - 1;
+    }
+
+    uint64_t idx = nfree_.back();
+    nfree_.pop_back();
+    nodes_[idx] = dNode();
+    return idx;
+  }
+
+  /* Copy len bits at spos of src to dpos of zero-filled dst */
+  static void copy_bits(block_t *dst, uint64_t dpos,
+                        const block_t *src, uint64_t spos, uint64_t len) {
+    for (uint64_t o = 0; o < len; o += BSIZE) {
+      size_t w = std::min(uint64_t(BSIZE), len - o);
+      put_bits(dst, dpos + o, w, get_bits(src, spos + o, w));
+    }
+  }
+
+  static uint64_t count_ones(const dLeaf& l) {
+    uint64_t r = 0;
+    for (size_t w = 0; w < DYNAMIC_LEAF_BNUM; w++)
+      r += popcount64(l.B[w]);
+    return r;
+  }
+
+  /* Insert into a subtree, and return a new sibling if it is split */
+  uint64_t insert(uint64_t idx, uint64_t lv, uint64_t pos, uint8_t bit) {
+    if (lv == 0)
+      return leaf_insert(idx, pos, bit);
+
+    size_t i = 0;
+    while (i + 1 < nodes_[idx].num && pos > nodes_[idx].size[i])
+      pos -= nodes_[idx].size[i++];
+
+    uint64_t c = nodes_[idx].child[i];
+    uint64_t s = insert(c, lv - 1, pos, bit);
+
+    dNode& n = nodes_[idx];
+    n.size[i]++;
+    n.ones[i] += bit;
+    if (s == NIL)
+      return NIL;
+
+    uint64_t size = 0;
+    uint64_t ones = 0;
+    summary(c, lv - 1, n.size[i], n.ones[i]);
+    summary(s, lv - 1, size, ones);
+    return node_insert(idx, i + 1, s, size, ones);
+  }
+
+  /* Add a child at i, splitting the node if it is full */
+  uint64_t node_insert(uint64_t idx, size_t i, uint64_t c,
+                       uint64_t size, uint64_t ones) {
+    uint64_t s = NIL;
+    if (nodes_[idx].num == DYNAMIC_FANOUT) {
+      s = alloc_node();
+
+      dNode& n = nodes_[idx];
+      dNode& sn = nodes_[s];
+      size_t half = DYNAMIC_FANOUT / 2;
+      for (size_t j = half; j < DYNAMIC_FANOUT; j++) {
+        sn.size[j - half] = n.size[j];
+        sn.ones[j - half] = n.ones[j];
+        sn.child[j - half] = n.child[j];
+      }
+
+      n.num = half;
+      sn.num = DYNAMIC_FANOUT - half;
+      if (i > half) {
+        idx = s;
+        i -= half;
+      }
+    }
+
+    dNode& n = nodes_[idx];
+    for (size_t j = n.num; j > i; j--) {
+      n.size[j] = n.size[j - 1];
+      n.ones[j] = n.ones[j - 1];
+      n.child[j] = n.child[j - 1];
+    }
+
+    n.size[i] = size;
+    n.ones[i] = ones;
+    n.child[i] = c;
+    n.num++;
+    return s;
+  }
+
+  uint64_t leaf_insert(uint64_t idx, uint64_t pos, uint8_t bit) {
+    uint64_t s = NIL;
+    if (leaves_[idx].size == DYNAMIC_LEAF_SZ) {
+      s = alloc_leaf();
+
+      dLeaf& l = leaves_[idx];
+      dLeaf& sl = leaves_[s];
+      size_t half = DYNAMIC_LEAF_BNUM / 2;
+      for (size_t w = half; w < DYNAMIC_LEAF_BNUM; w++) {
+        sl.B[w - half] = l.B[w];
+        l.B[w] = 0;
+      }
+
+      l.size = sl.size = DYNAMIC_LEAF_SZ / 2;
+      sl.ones = count_ones(sl);
+      l.ones -= sl.ones;
+      if (pos > l.size) {
+        pos -= l.size;
+        idx = s;
+      }
+    }
+
+    /* Shift the bits from pos by one */
+    dLeaf& l = leaves_[idx];
+    size_t w0 = pos / BSIZE;
+    for (size_t w = l.size / BSIZE; w > w0; w--)
+      l.B[w] = (l.B[w] << 1) | (l.B[w - 1] >> (BSIZE - 1));
+
+    block_t mask = (uint64_t(1) << (pos % BSIZE)) - 1;
+    block_t b = l.B[w0];
+    l.B[w0] = (b & mask) | ((b & ~mask) << 1) |
+        (block_t(bit) << (pos % BSIZE));
+
+    l.size++;
+    l.ones += bit;
+    return s;
+  }
+
+  /* Erase from a subtree, and return the erased bit */
+  uint8_t erase(uint64_t idx, uint64_t lv, uint64_t pos) {
+    if (lv == 0)
+      return leaf_erase(idx, pos);
+
+    size_t i = 0;
+    while (pos >= nodes_[idx].size[i])
+      pos -= nodes_[idx].size[i++];
+
+    uint64_t c = nodes_[idx].child[i];
+    uint8_t bit = erase(c, lv - 1, pos);
+
+    dNode& n = nodes_[idx];
+    n.size[i]--;
+    n.ones[i] -= bit;
+
+    bool under = (lv == 1)? leaves_[c].size < DYNAMIC_LEAF_SZ / 4 :
+        nodes_[c].num < DYNAMIC_FANOUT / 4;
+    if (under && n.num > 1)
+      rebalance(idx, lv, (i + 1 < n.num)? i : i - 1);
+
+    return bit;
+  }
+
+  uint8_t leaf_erase(uint64_t idx, uint64_t pos) {
+    dLeaf& l = leaves_[idx];
+    size_t w0 = pos / BSIZE;
+    size_t last = (l.size - 1) / BSIZE;
+    uint8_t bit = (l.B[w0] >> (pos % BSIZE)) & 1;
+
+    /* Shift the bits after pos back by one */
+    block_t mask = (uint64_t(1) << (pos % BSIZE)) - 1;
+    block_t b = l.B[w0];
+    l.B[w0] = (b & mask) | ((b >> 1) & ~mask);
+    for (size_t w = w0; w < last; w++) {
+      l.B[w] |= l.B[w + 1] << (BSIZE - 1);
+      l.B[w + 1] >>= 1;
+    }
+
+    l.size--;
+    l.ones -= bit;
+    return bit;
+  }
+
+  /* Merge the i-th and (i + 1)-th children, or share their items */
+  void rebalance(uint64_t idx, uint64_t lv, size_t i) {
+    dNode& n = nodes_[idx];
+    uint64_t lc = n.child[i];
+    uint64_t rc = n.child[i + 1];
+    bool merge = false;
+
+    if (lv == 1) {
+      dLeaf& l = leaves_[lc];
+      dLeaf& r = leaves_[rc];
+      uint64_t total = l.size + r.size;
+
+      std::vector<block_t> tmp(2 * DYNAMIC_LEAF_BNUM, 0);
+      copy_bits(tmp.data(), 0, l.B, 0, l.size);
+      copy_bits(tmp.data(), l.size, r.B, 0, r.size);
+
+      merge = total <= DYNAMIC_LEAF_SZ;
+      uint64_t lsize = (merge)? total : total / 2;
+
+      l = dLeaf(), r = dLeaf();
+      l.size = lsize;
+      r.size = total - lsize;
+      copy_bits(l.B, 0, tmp.data(), 0, l.size);
+      copy_bits(r.B, 0, tmp.data(), l.size, r.size);
+      l.ones = count_ones(l);
+      r.ones = count_ones(r);
+
+      if (merge)
+        lfree_.push_back(rc);
+    } else {
+      dNode& l = nodes_[lc];
+      dNode& r = nodes_[rc];
+      size_t total = l.num + r.num;
+
+      dNode tmp[2] = {l, r};
+      merge = total <= DYNAMIC_FANOUT;
+      size_t lnum = (merge)? total : total / 2;
+
+      l.num = r.num = 0;
+      for (size_t j = 0; j < total; j++) {
+        const dNode& src = tmp[j >= tmp[0].num];
+        size_t k = (j >= tmp[0].num)? j - tmp[0].num : j;
+
+        dNode& dst = (j < lnum)? l : r;
+        dst.size[dst.num] = src.size[k];
+        dst.ones[dst.num] = src.ones[k];
+        dst.child[dst.num] = src.child[k];
+        dst.num++;
+      }
+
+      if (merge)
+        nfree_.push_back(rc);
+    }
+
+    summary(lc, lv - 1, n.size[i], n.ones[i]);
+    if (!merge) {
+      summary(rc, lv - 1, n.size[i + 1], n.ones[i + 1]);
+      return;
+    }
+
+    for (size_t j = i + 1; j + 1 < n.num; j++) {
+      n.size[j] = n.size[j + 1];
+      n.ones[j] = n.ones[j + 1];
+      n.child[j] = n.child[j + 1];
+    }
+
+    n.num--;
+  }
+
+  void freeze(uint64_t idx, uint64_t lv, SuccinctBitVector& sbv,
+              uint64_t& off) const {
+    if (lv > 0) {
+      const dNode& n = nodes_[idx];
+      for (size_t i = 0; i < n.num; i++)
+        freeze(n.child[i], lv - 1, sbv, off);
+      return;
+    }
+
+    const dLeaf& l = leaves_[idx];
+    for (size_t w = 0; w < DYNAMIC_LEAF_BNUM; w++) {
+      for (block_t blk = l.B[w]; blk != 0; blk &= blk - 1)
+        sbv.set_bit(off + w * BSIZE + __builtin_ctzll(blk), 1);
+    }
+
+    off += l.size;
+  }
+
+  uint64_t  size_;
+  uint64_t  none_;
+  uint64_t  height_;
+  uint64_t  root_;
+
+  std::vector<dLeaf>    leaves_;
+  std::vector<dNode>    nodes_;
+
+  /* Indices of the leaves and nodes released by merges */
+  std::vector<uint64_t> lfree_;
+  std::vector<uint64_t> nfree_;
+}; /* DynamicSuccinctBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __DYNAMICSUCCINCTBITVECTOR_HPP__ */
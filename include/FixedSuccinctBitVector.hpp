@@ -0,0 +1,180 @@
+/*-----------------------------------------------------------------------------
+ *  FixedSuccinctBitVector.hpp - A rank/select dictionary of fixed capacity
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __FIXEDSUCCINCTBITVECTOR_HPP__
+#define __FIXEDSUCCINCTBITVECTOR_HPP__
+
+#include <array>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+/* Bits counted by an entry of the directory */
+static const size_t FIXED_SB_SZ = 512;
+
+/* A sequence of indices to fill the directory in constexpr */
+template<size_t... I> struct fIndices {};
+
+template<size_t N, size_t... I>
+struct fMakeIndices : fMakeIndices<N - 1, N - 1, I...> {};
+
+template<size_t... I>
+struct fMakeIndices<0, I...> {
+  typedef fIndices<I...> type;
+};
+
+/*
+ * FixedSuccinctBitVector keeps N bits in an inline std::array
+ * with no allocation, so it can be embedded by value. For N larger
+ * than FIXED_SB_SZ, the number of ones before every FIXED_SB_SZ
+ * bits is kept in a directory of 16-bit entries that set_bit()
+ * keeps up to date; otherwise the blocks are scanned. The last
+ * entry is the number of all the ones. The 16-bit entries are padded
+ * to the alignment of the blocks, so even with no directory the
+ * object takes 8 bytes more than its blocks, e.g. 72 bytes for
+ * N = 512. Queries are constexpr, and a vector is built in constexpr
+ * from its blocks, whose bits beyond N must be zero.
+ */
+template<size_t N>
+class FixedSuccinctBitVector {
+ public:
+  static const size_t BNUM = (N + BSIZE - 1) / BSIZE;
+  static const size_t SB_BNUM = FIXED_SB_SZ / BSIZE;
+  static const size_t DNUM = (N > FIXED_SB_SZ)? N / FIXED_SB_SZ + 1 : 0;
+
+  static_assert(N != 0 && N < 65536, "N must be in [1, 65536)");
+
+  constexpr FixedSuccinctBitVector() : B_(), dir_() {}
+  constexpr explicit FixedSuccinctBitVector(
+      const std::array<block_t, BNUM>& b) :
+      FixedSuccinctBitVector(b, typename fMakeIndices<DNUM>::type()) {}
+
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (pos >= N)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    block_t mask = uint64_t(1) << (pos % BSIZE);
+    block_t& blk = B_[pos / BSIZE];
+    if (((blk & mask) != 0) == (bit != 0))
+      return;
+
+    blk ^= mask;
+    for (size_t s = (DNUM)? pos / FIXED_SB_SZ + 1 : 0; s <= DNUM; s++) {
+      if (bit)
+        dir_[s]++;
+      else
+        dir_[s]--;
+    }
+  }
+
+  constexpr bool lookup(uint64_t pos) const {
+    return (pos >= N)? throw "Invalid input: pos" :
+        (B_[pos / BSIZE] >> (pos % BSIZE)) & 1;
+  }
+
+  /* Rank & Select operations */
+  constexpr uint64_t rank(uint64_t pos, uint8_t bit) const {
+    return (pos >= N)? throw "Invalid input: pos" :
+        (bit > 1)? throw "Invalid input: bit" :
+        (bit)? rank1(pos + 1) : pos + 1 - rank1(pos + 1);
+  }
+
+  constexpr uint64_t select(uint64_t pos, uint8_t bit) const {
+    return (bit > 1)? throw "Invalid input: bit" :
+        (pos >= ((bit)? get_none() : N - get_none()))?
+        throw "Invalid input: pos" :
+        select_in(pos, bit, find(pos, bit, 0));
+  }
+
+  constexpr uint64_t length() const {
+    return N;
+  }
+
+  constexpr uint64_t get_none() const {
+    return dir_[DNUM];
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  template<size_t... I>
+  constexpr FixedSuccinctBitVector(const std::array<block_t, BNUM>& b,
+                                   fIndices<I...>) :
+      B_(b), dir_{{static_cast<uint16_t>(ones(b, 0, I * SB_BNUM))...,
+                   static_cast<uint16_t>(ones(b, 0, BNUM))}} {}
+
+  static constexpr uint64_t count(block_t b) {
+    return __builtin_popcountll(b);
+  }
+
+  /* The number of ones in blocks [l, r), halved for shallow calls */
+  static constexpr uint64_t ones(const std::array<block_t, BNUM>& b,
+                                 size_t l, size_t r) {
+    return (l >= r || l >= BNUM)? 0 :
+        (r - l == 1)? count(b[l]) :
+        ones(b, l, (l + r) / 2) + ones(b, (l + r) / 2, r);
+  }
+
+  /* The number of ones in [0, pos) */
+  constexpr uint64_t rank1(uint64_t pos) const {
+    return ((DNUM)? dir_[pos / FIXED_SB_SZ] : 0) +
+        ones(B_, (DNUM)? pos / FIXED_SB_SZ * SB_BNUM : 0, pos / BSIZE) +
+        ((pos % BSIZE)? count(B_[pos / BSIZE] &
+                              ((uint64_t(1) << (pos % BSIZE)) - 1)) : 0);
+  }
+
+  constexpr uint64_t cumltv(size_t s, uint8_t bit) const {
+    return (!DNUM)? 0 : (bit)? dir_[s] : s * FIXED_SB_SZ - dir_[s];
+  }
+
+  /* The last entry from s whose cumulative count <= pos */
+  constexpr size_t find(uint64_t pos, uint8_t bit, size_t s) const {
+    return (s + 1 < DNUM && cumltv(s + 1, bit) <= pos)?
+        find(pos, bit, s + 1) : s;
+  }
+
+  constexpr uint64_t select_in(uint64_t pos, uint8_t bit,
+                               size_t s) const {
+    return select_word(pos - cumltv(s, bit), bit, s * SB_BNUM);
+  }
+
+  constexpr block_t word(size_t w, uint8_t bit) const {
+    return (bit)? B_[w] : ~B_[w];
+  }
+
+  /* Scan blocks from w, which never go over the last one */
+  constexpr uint64_t select_word(uint64_t rem, uint8_t bit,
+                                 size_t w) const {
+    return (rem < count(word(w, bit)) || w + 1 >= BNUM)?
+        w * BSIZE + select64(word(w, bit), rem, BSIZE) :
+        select_word(rem - count(word(w, bit)), bit, w + 1);
+  }
+
+  /* The offset of the r-th one in the lower w bits of blk */
+  static constexpr uint64_t select64(block_t blk, uint64_t r, size_t w) {
+    return (w == 1)? 0 :
+        (count(blk & ((uint64_t(1) << (w / 2)) - 1)) > r)?
+        select64(blk, r, w / 2) :
+        w / 2 + select64(blk >> (w / 2),
+                         r - count(blk & ((uint64_t(1) << (w / 2)) - 1)),
+                         w / 2);
+  }
+
+  std::array<block_t, BNUM>       B_;
+  std::array<uint16_t, DNUM + 1>  dir_;
+}; /* FixedSuccinctBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __FIXEDSUCCINCTBITVECTOR_HPP__ */
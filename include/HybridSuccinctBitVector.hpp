@@ -0,0 +1,377 @@
+/*-----------------------------------------------------------------------------
+ *  HybridSuccinctBitVector.hpp - A rank/select dictionary with per-group codes
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __HYBRIDSUCCINCTBITVECTOR_HPP__
+#define __HYBRIDSUCCINCTBITVECTOR_HPP__
+
+#include <algorithm>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace hybrid {
+
+using dense::block_t;
+using dense::BSIZE;
+using dense::popcount64;
+using dense::selectPos;
+
+static const size_t HYBRID_GROUP_SZ = 1024;
+static const size_t HYBRID_GROUP_BNUM = HYBRID_GROUP_SZ / BSIZE;
+
+/* Encodings of a group */
+enum {
+  HB_ZEROS = 0,
+  HB_ONES,
+  HB_RAW,
+  HB_SPARSE,
+  HB_RUNS,
+  HB_NUM
+};
+
+/*
+ * An entry of the directory: the number of ones before the group,
+ * the offset of its data in 16-bit units, the encoding and the
+ * number of items in the data.
+ */
+typedef struct {
+  uint64_t  rk;
+  uint64_t  off : 48;
+  uint64_t  type : 4;
+  uint64_t  n : 12;
+} hEntry;
+
+/*
+ * SuccinctBitVector with hybrid encodings: bits are divided into
+ * groups of HYBRID_GROUP_SZ bits, and each group is kept in the
+ * smallest of raw words, a list of positions of ones, a list of
+ * runs of ones, or nothing if all the bits are the same. Runs are
+ * kept as pairs of a start and the number of ones before it. The
+ * directory over the groups is the same for all the encodings, so
+ * a query searches it and decodes a single group.
+ */
+class SuccinctBitVector {
+ public:
+  SuccinctBitVector() : size_(0) {}
+  ~SuccinctBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    if (size == 0)
+      throw "Invalid input: size";
+
+    bv_.init(size);
+    size_ = size;
+  }
+
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (pos >= bv_.length())
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    bv_.set_bit(pos, bit);
+  }
+
+  /* Encode the bits, which are released after that */
+  void build() {
+    if (bv_.length() == 0)
+      throw "Not initialized yet: bv_";
+
+    uint64_t ngroups = (size_ + HYBRID_GROUP_SZ - 1) / HYBRID_GROUP_SZ;
+    dir_.clear();
+    data_.clear();
+
+    uint64_t r = 0;
+    for (uint64_t g = 0; g < ngroups; g++) {
+      hEntry e = {r, data_.size(), HB_RAW, 0};
+      r += encode(g, e);
+      dir_.push_back(e);
+    }
+
+    /* A sentinel to bound the last group */
+    hEntry e = {r, data_.size(), HB_ZEROS, 0};
+    dir_.push_back(e);
+
+    bv_ = dense::BitVector();
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    uint64_t g = pos / HYBRID_GROUP_SZ;
+    return rank1(g, pos % HYBRID_GROUP_SZ + 1) -
+        rank1(g, pos % HYBRID_GROUP_SZ) > 0;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t g = pos / HYBRID_GROUP_SZ;
+    uint64_t r = dir_[g].rk + rank1(g, pos % HYBRID_GROUP_SZ + 1);
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? get_none() : size_ - get_none()))
+      throw "Invalid input: pos";
+
+    /* Find the last group whose cumulative count <= pos */
+    uint64_t lo = 0;
+    uint64_t hi = dir_.size() - 2;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo + 1) / 2;
+      if (cumltv(mid, bit) <= pos)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    return lo * HYBRID_GROUP_SZ + select(lo, pos - cumltv(lo, bit), bit);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return dir_.empty()? 0 : dir_.back().rk;
+  }
+
+  /* The number of groups in an encoding */
+  uint64_t group_num(uint64_t type) const {
+    uint64_t n = 0;
+    for (size_t g = 0; g + 1 < dir_.size(); g++)
+      n += (dir_[g].type == type);
+    return n;
+  }
+
+  /* The size of the encoded data in bytes */
+  uint64_t space() const {
+    return dir_.size() * sizeof(hEntry) + data_.size() * sizeof(uint16_t);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  /* Encode the g-th group in the smallest, and return its ones */
+  uint64_t encode(uint64_t g, hEntry& e) {
+    block_t blk[HYBRID_GROUP_BNUM];
+    uint64_t len = std::min(HYBRID_GROUP_SZ, size_ - g * HYBRID_GROUP_SZ);
+
+    uint64_t ones = 0;
+    uint64_t nruns = 0;
+    for (size_t i = 0; i < HYBRID_GROUP_BNUM; i++) {
+      uint64_t b = g * HYBRID_GROUP_BNUM + i;
+      blk[i] = (b < bv_.bsize())? bv_.get_block(b) : 0;
+      ones += popcount64(blk[i]);
+
+      /* Count the starts of runs of ones */
+      block_t prev = (i)? blk[i - 1] >> (BSIZE - 1) : 0;
+      nruns += popcount64(blk[i] & ~((blk[i] << 1) | prev));
+    }
+
+    if (ones == 0 || ones == len) {
+      e.type = (ones)? HB_ONES : HB_ZEROS;
+      return ones;
+    }
+
+    /* Sizes in 16-bit units */
+    uint64_t sz[HB_NUM] = {0, 0, HYBRID_GROUP_BNUM * 4, ones, nruns * 2};
+
+    e.type = HB_RAW;
+    for (uint64_t t = HB_SPARSE; t < HB_NUM; t++) {
+      if (sz[t] < sz[e.type])
+        e.type = t;
+    }
+
+    if (e.type == HB_RAW) {
+      for (size_t i = 0; i < HYBRID_GROUP_BNUM; i++) {
+        for (size_t j = 0; j < 4; j++)
+          data_.push_back(blk[i] >> (j * 16));
+      }
+    } else {
+      uint64_t r = 0;
+      for (uint64_t p = 0; p < len; p++) {
+        bool b = (blk[p / BSIZE] >> (p % BSIZE)) & 1;
+        bool prev = p && ((blk[(p - 1) / BSIZE] >> ((p - 1) % BSIZE)) & 1);
+
+        if (b && e.type == HB_SPARSE) {
+          data_.push_back(p);
+        } else if (b && !prev) {
+          data_.push_back(p);
+          data_.push_back(r);
+        }
+
+        r += b;
+      }
+    }
+
+    e.n = (e.type == HB_SPARSE)? ones : nruns;
+    return ones;
+  }
+
+  const uint16_t *data(uint64_t g) const {
+    return data_.data() + dir_[g].off;
+  }
+
+  block_t raw_block(uint64_t g, size_t i) const {
+    const uint16_t *d = data(g) + i * 4;
+    return block_t(d[0]) | (block_t(d[1]) << 16) |
+        (block_t(d[2]) << 32) | (block_t(d[3]) << 48);
+  }
+
+  /* The number of ones in the first pos bits of the g-th group */
+  uint64_t rank1(uint64_t g, uint64_t pos) const {
+    const hEntry& e = dir_[g];
+    const uint16_t *d = data(g);
+
+    switch (e.type) {
+      case HB_ZEROS:
+        return 0;
+      case HB_ONES:
+        return pos;
+      case HB_RAW: {
+        uint64_t r = 0;
+        for (size_t i = 0; i < pos / BSIZE; i++)
+          r += popcount64(raw_block(g, i));
+        if (pos % BSIZE != 0)
+          r += popcount64(raw_block(g, pos / BSIZE) &
+                          ((uint64_t(1) << (pos % BSIZE)) - 1));
+        return r;
+      }
+      case HB_SPARSE:
+        return std::lower_bound(d, d + e.n, pos) - d;
+      case HB_RUNS: {
+        /* The last run starting before pos */
+        uint64_t lo = 0;
+        uint64_t hi = e.n;
+        while (lo < hi) {
+          uint64_t mid = lo + (hi - lo) / 2;
+          if (d[mid * 2] < pos)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+        if (lo == 0)
+          return 0;
+
+        uint64_t i = lo - 1;
+        return d[i * 2 + 1] +
+            std::min<uint64_t>(pos - d[i * 2], run_len(g, i));
+      }
+    }
+
+    return 0;
+  }
+
+  /* The position of the pos-th bit in the g-th group */
+  uint64_t select(uint64_t g, uint64_t pos, uint8_t bit) const {
+    const hEntry& e = dir_[g];
+    const uint16_t *d = data(g);
+
+    switch (e.type) {
+      case HB_ZEROS:
+      case HB_ONES:
+        return pos;
+      case HB_RAW:
+        for (size_t i = 0;; i++) {
+          block_t blk = (bit)? raw_block(g, i) : ~raw_block(g, i);
+          uint64_t n = popcount64(blk);
+          if (pos < n)
+            return i * BSIZE + selectPos(blk, pos);
+          pos -= n;
+        }
+      case HB_SPARSE:
+        if (bit)
+          return d[pos];
+
+        /* The number of ones before the pos-th zero */
+        return pos + search(d, 1, e.n, pos);
+      case HB_RUNS: {
+        if (!bit) {
+          uint64_t m = search(d, 2, e.n, pos);
+          return pos + ((m < e.n)? d[m * 2 + 1] : ones(g));
+        }
+
+        /* The last run with ones before it <= pos */
+        uint64_t lo = 0;
+        uint64_t hi = e.n - 1;
+        while (lo < hi) {
+          uint64_t mid = lo + (hi - lo + 1) / 2;
+          if (d[mid * 2 + 1] <= pos)
+            lo = mid;
+          else
+            hi = mid - 1;
+        }
+
+        return d[lo * 2] + pos - d[lo * 2 + 1];
+      }
+    }
+
+    return 0;
+  }
+
+  /*
+   * The number of items i in [0, n) such that d[i * step] minus
+   * the ones before it is not more than pos, i.e. zeros before
+   * the item. The ones before an item is i for a list of ones
+   * and d[i * step + 1] for runs.
+   */
+  static uint64_t search(const uint16_t *d, size_t step,
+                         uint64_t n, uint64_t pos) {
+    uint64_t lo = 0;
+    uint64_t hi = n;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      uint64_t before = (step == 1)? mid : d[mid * 2 + 1];
+      if (d[mid * step] - before <= pos)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return lo;
+  }
+
+  uint64_t ones(uint64_t g) const {
+    return dir_[g + 1].rk - dir_[g].rk;
+  }
+
+  uint64_t run_len(uint64_t g, uint64_t i) const {
+    const uint16_t *d = data(g);
+    return ((i + 1 < dir_[g].n)? d[i * 2 + 3] : ones(g)) - d[i * 2 + 1];
+  }
+
+  uint64_t cumltv(uint64_t g, uint8_t bit) const {
+    return (bit)? dir_[g].rk : g * HYBRID_GROUP_SZ - dir_[g].rk;
+  }
+
+  uint64_t  size_;
+
+  /* Bits kept until build() */
+  dense::BitVector bv_;
+
+  std::vector<hEntry>     dir_;
+  std::vector<uint16_t>   data_;
+}; /* SuccinctBitVector */
+
+} /* hybrid */
+} /* succinct */
+
+#endif /* __HYBRIDSUCCINCTBITVECTOR_HPP__ */
@@ -0,0 +1,195 @@
+/*-----------------------------------------------------------------------------
+ *  InterleavedExecutor.hpp - Interleaved execution of dependent query chains
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __INTERLEAVEDEXECUTOR_HPP__
+#define __INTERLEAVEDEXECUTOR_HPP__
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+enum {
+  QUERY_NONE = 0,
+  QUERY_RANK,
+  QUERY_SELECT
+};
+
+/* A query of a chain and the result of it */
+typedef struct {
+  uint64_t  op;
+  uint64_t  bit;
+  uint64_t  pos;
+  uint64_t  ret;
+} qQuery;
+
+/*
+ * InterleavedExecutor runs many independent chains of queries,
+ * in each of which a query depends on the result of the last one.
+ * A query is split into stages that end with a prefetch of the
+ * data the next stage reads, and the executor switches among
+ * up to group_sz chains at every stage, so the memory latency
+ * of a chain is overlapped with the work of the others.
+ */
+class InterleavedExecutor {
+ public:
+  static const size_t GROUP_SZ = 16;
+
+  explicit InterleavedExecutor(const SuccinctBitVector& sbv,
+                               size_t group_sz = GROUP_SZ) :
+      rk_(sbv.rk_), group_sz_(std::max(group_sz, size_t(1))) {
+    if (!rk_)
+      throw "Not built yet: rk_";
+
+    st_[0] = sbv.st0_, st_[1] = sbv.st1_;
+  }
+  ~InterleavedExecutor() throw() {}
+
+  /*
+   * Run chains [0, nchains). step(id, q) is first called with
+   * q.op == QUERY_NONE, and then with the last query of the
+   * chain and its result in q.ret. It sets the next query in q
+   * and returns true, or returns false at the end of the chain.
+   */
+  void run(size_t nchains,
+           const std::function<bool(size_t, qQuery&)>& step) {
+    std::vector<qSlot> slot(std::min(group_sz_, nchains));
+
+    size_t next = 0;
+    size_t nactive = 0;
+    for (size_t i = 0; i < slot.size(); i++) {
+      if (start(slot[i], next, nchains, step))
+        nactive++;
+    }
+
+    while (nactive != 0) {
+      for (size_t i = 0; i < slot.size(); i++) {
+        qSlot& s = slot[i];
+        if (s.stage == STAGE_DONE)
+          continue;
+
+        if (!advance(s))
+          continue;
+
+        /* The query is done, so the next one is issued */
+        if (!issue(s, step) && !start(s, next, nchains, step))
+          nactive--;
+      }
+    }
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  enum {
+    STAGE_DONE = 0,
+    STAGE_RANK,
+    STAGE_HINT,
+    STAGE_SEARCH
+  };
+
+  typedef struct {
+    size_t    id;
+    uint64_t  stage;
+    uint64_t  lo;
+    uint64_t  hi;
+    qQuery    q;
+  } qSlot;
+
+  /* Assign chains to a slot until one issues a query */
+  bool start(qSlot& s, size_t& next, size_t nchains,
+             const std::function<bool(size_t, qQuery&)>& step) {
+    while (next < nchains) {
+      s.id = next++;
+      s.q.op = QUERY_NONE;
+      if (issue(s, step))
+        return true;
+    }
+
+    s.stage = STAGE_DONE;
+    return false;
+  }
+
+  /* Get the next query of a chain and prefetch for it */
+  bool issue(qSlot& s,
+             const std::function<bool(size_t, qQuery&)>& step) {
+    if (!step(s.id, s.q)) {
+      s.stage = STAGE_DONE;
+      return false;
+    }
+
+    if (s.q.bit > 1)
+      throw "Invalid input: bit";
+
+    if (s.q.op == QUERY_RANK) {
+      if (s.q.pos >= rk_->length())
+        throw "Invalid input: pos";
+
+      __builtin_prefetch(&rk_->get_rblock((s.q.pos + 1) / PRESUM_SZ));
+      s.stage = STAGE_RANK;
+    } else if (s.q.op == QUERY_SELECT) {
+      const SuccinctSelect& st = *st_[s.q.bit];
+      if (s.q.pos >= st.size())
+        throw "Invalid input: pos";
+
+      __builtin_prefetch(&st.hints_[s.q.pos / st.sample_]);
+      s.stage = STAGE_HINT;
+    } else {
+      throw "Invalid input: op";
+    }
+
+    return true;
+  }
+
+  /* Run a stage of a query, and return true if it is done */
+  bool advance(qSlot& s) {
+    const rBlock *rblk = rk_->rblocks();
+    qQuery& q = s.q;
+
+    switch (s.stage) {
+      case STAGE_RANK: {
+        uint64_t pos = q.pos + 1;
+        uint64_t r = rblock_rank1(rblk[pos / PRESUM_SZ], pos);
+        q.ret = (q.bit)? r : pos - r;
+        return true;
+      }
+      case STAGE_HINT: {
+        const std::vector<uint64_t>& hints = st_[q.bit]->hints_;
+        uint64_t hidx = q.pos / st_[q.bit]->sample_;
+
+        s.lo = hints[hidx];
+        s.hi = hints[hidx + 1];
+        __builtin_prefetch(&rblk[s.lo]);
+        s.stage = STAGE_SEARCH;
+        return false;
+      }
+      case STAGE_SEARCH: {
+        uint64_t i = rblock_search(rblk, s.lo, s.hi, q.pos, q.bit);
+        uint64_t rem = q.pos - rblock_cumltv(rblk[i], i, q.bit);
+        q.ret = i * PRESUM_SZ + rblock_select(rblk[i], rem, q.bit);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  RankPtr   rk_;
+  SelectPtr st_[2];
+  size_t    group_sz_;
+}; /* InterleavedExecutor */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __INTERLEAVEDEXECUTOR_HPP__ */
@@ -0,0 +1,207 @@
+/*-----------------------------------------------------------------------------
+ *  MultiBitVector.hpp - K rank/select dictionaries interleaved in blocks
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __MULTIBITVECTOR_HPP__
+#define __MULTIBITVECTOR_HPP__
+
+#include <array>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * MultiBitVector keeps K bit-vectors of the same length. The
+ * words and counts of all the vectors for the same PRESUM_SZ
+ * bits are stored next to each other in an mBlock, so
+ * rank_all() and lookup_all() load a single mBlock, which
+ * spans one or two cache-lines for a small K. The kernels of
+ * rBlock are used on a view of each vector in an mBlock.
+ */
+template <size_t K>
+class MultiBitVector {
+  static_assert(K >= 1 && K <= BSIZE, "K must be in [1, BSIZE]");
+
+ public:
+  MultiBitVector() : size_(0) {}
+  ~MultiBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    if (size == 0)
+      throw "Invalid input: size";
+
+    size_ = size;
+    mblk_.assign(size / PRESUM_SZ + 1, mBlock());
+    none_.fill(0);
+  }
+
+  void set_bit(size_t k, uint64_t pos, uint8_t bit) {
+    if (k >= K)
+      throw "Invalid input: k";
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    block_t& blk = mblk_[pos / PRESUM_SZ].b[(pos / BSIZE) % 2][k];
+    block_t mask = uint64_t(1) << (pos % BSIZE);
+
+    if (bit)
+      blk |= mask;
+    else
+      blk &= ~mask;
+  }
+
+  void build() {
+    if (size_ == 0)
+      throw "Not initialized yet: size_";
+
+    for (size_t k = 0; k < K; k++) {
+      uint64_t r = 0;
+      for (size_t i = 0; i < mblk_.size(); i++) {
+        mblk_[i].rk[k] = r;
+        r += popcount64(mblk_[i].b[0][k]) + popcount64(mblk_[i].b[1][k]);
+      }
+
+      none_[k] = r;
+    }
+  }
+
+  bool lookup(size_t k, uint64_t pos) const {
+    if (k >= K)
+      throw "Invalid input: k";
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    block_t blk = mblk_[pos / PRESUM_SZ].b[(pos / BSIZE) % 2][k];
+    return (blk & (uint64_t(1) << (pos % BSIZE))) > 0;
+  }
+
+  /* The bits of all the vectors at pos; the k-th bit for k */
+  uint64_t lookup_all(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    const block_t *b = mblk_[pos / PRESUM_SZ].b[(pos / BSIZE) % 2];
+    uint64_t ret = 0;
+    for (size_t k = 0; k < K; k++)
+      ret |= ((b[k] >> (pos % BSIZE)) & 1) << k;
+
+    return ret;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(size_t k, uint64_t pos, uint8_t bit) const {
+    if (k >= K)
+      throw "Invalid input: k";
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    uint64_t r = rblock_rank1(view(pos / PRESUM_SZ, k), pos);
+    return (bit)? r : pos - r;
+  }
+
+  std::array<uint64_t, K> rank_all(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    std::array<uint64_t, K> ret;
+    for (size_t k = 0; k < K; k++) {
+      uint64_t r = rblock_rank1(view(pos / PRESUM_SZ, k), pos);
+      ret[k] = (bit)? r : pos - r;
+    }
+
+    return ret;
+  }
+
+  uint64_t select(size_t k, uint64_t pos, uint8_t bit) const {
+    if (k >= K)
+      throw "Invalid input: k";
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= count(k, bit))
+      throw "Invalid input: pos";
+
+    /* Find the last mBlock whose cumulative count <= pos */
+    uint64_t lo = 0;
+    uint64_t hi = mblk_.size() - 1;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo + 1) / 2;
+      if (cumltv(mid, k, bit) <= pos)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    rBlock rblk = view(lo, k);
+    rblk.b0sum = popcount64(rblk.b0);
+
+    uint64_t rem = pos - cumltv(lo, k, bit);
+    return lo * PRESUM_SZ + rblock_select(rblk, rem, bit);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none(size_t k) const {
+    if (k >= K)
+      throw "Invalid input: k";
+
+    return none_[k];
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  typedef struct mBlock {
+    uint64_t  rk[K];
+    block_t   b[2][K];
+
+    mBlock() {
+      memset(this, 0x00, sizeof(*this));
+    }
+  } mBlock;
+
+  /* An rBlock of the k-th vector without b0sum */
+  rBlock view(uint64_t idx, size_t k) const {
+    const mBlock& mblk = mblk_[idx];
+    rBlock rblk = {mblk.b[0][k], mblk.b[1][k], mblk.rk[k], 0};
+    return rblk;
+  }
+
+  uint64_t cumltv(uint64_t idx, size_t k, uint8_t bit) const {
+    return (bit)? mblk_[idx].rk[k] : idx * PRESUM_SZ - mblk_[idx].rk[k];
+  }
+
+  uint64_t count(size_t k, uint8_t bit) const {
+    return (bit)? none_[k] : size_ - none_[k];
+  }
+
+  uint64_t  size_;
+
+  std::vector<mBlock>       mblk_;
+  std::array<uint64_t, K>   none_;
+}; /* MultiBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __MULTIBITVECTOR_HPP__ */
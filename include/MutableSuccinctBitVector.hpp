@@ -0,0 +1,245 @@
+/*-----------------------------------------------------------------------------
+ *  MutableSuccinctBitVector.hpp - A rank/select dictionary with bit updates
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __MUTABLESUCCINCTBITVECTOR_HPP__
+#define __MUTABLESUCCINCTBITVECTOR_HPP__
+
+#include <algorithm>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+/* Bits counted by a node of the Fenwick tree */
+static const size_t MUTABLE_SB_SZ = 512;
+static const size_t MUTABLE_SB_BNUM = MUTABLE_SB_SZ / BSIZE;
+
+/*
+ * MutableSuccinctBitVector allows bits to be updated after build().
+ * The ones in every MUTABLE_SB_SZ bits are counted in a Fenwick
+ * tree, so an update adds to O(log n) nodes, rank sums O(log n)
+ * nodes, and select descends the tree in O(log n) steps before
+ * scanning the blocks of a superblock. It is built from bits or
+ * a built SuccinctBitVector, and frozen into a SuccinctBitVector
+ * for static queries again.
+ */
+class MutableSuccinctBitVector {
+ public:
+  MutableSuccinctBitVector() : size_(0), none_(0), nsb_(0), top_(0) {}
+  explicit MutableSuccinctBitVector(const SuccinctBitVector& sbv) :
+      size_(0), none_(0), nsb_(0), top_(0) {
+    if (!sbv.rk_)
+      throw "Not built yet: rk_";
+
+    init(sbv.length());
+    for (size_t i = 0; i < sbv.bv_.bsize(); i++)
+      B_[i] = sbv.bv_.get_block(i);
+
+    build();
+  }
+  ~MutableSuccinctBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    if (size == 0)
+      throw "Invalid input: size";
+
+    size_ = size;
+    nsb_ = size / MUTABLE_SB_SZ + 1;
+    B_.assign(nsb_ * MUTABLE_SB_BNUM, 0);
+    tree_.clear();
+
+    top_ = 1;
+    while (top_ * 2 <= nsb_)
+      top_ *= 2;
+  }
+
+  /* Bits can be updated before or after build() */
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    block_t mask = uint64_t(1) << (pos % BSIZE);
+    block_t& blk = B_[pos / BSIZE];
+    if (((blk & mask) != 0) == (bit != 0))
+      return;
+
+    blk ^= mask;
+    if (tree_.empty())
+      return;
+
+    /* Update the nodes covering the superblock */
+    for (uint64_t i = pos / MUTABLE_SB_SZ + 1; i <= nsb_; i += i & -i) {
+      if (bit)
+        tree_[i]++;
+      else
+        tree_[i]--;
+    }
+
+    if (bit)
+      none_++;
+    else
+      none_--;
+  }
+
+  void set(uint64_t pos) {
+    set_bit(pos, 1);
+  }
+
+  void clear(uint64_t pos) {
+    set_bit(pos, 0);
+  }
+
+  void flip(uint64_t pos) {
+    set_bit(pos, !lookup(pos));
+  }
+
+  /* Build the Fenwick tree in linear time */
+  void build() {
+    if (B_.empty())
+      throw "Not initialized yet: B_";
+
+    tree_.assign(nsb_ + 1, 0);
+    none_ = 0;
+    for (uint64_t i = 1; i <= nsb_; i++) {
+      uint64_t n = 0;
+      for (size_t w = 0; w < MUTABLE_SB_BNUM; w++)
+        n += popcount64(B_[(i - 1) * MUTABLE_SB_BNUM + w]);
+
+      none_ += n;
+      tree_[i] += n;
+      if (i + (i & -i) <= nsb_)
+        tree_[i + (i & -i)] += tree_[i];
+    }
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    return (B_[pos / BSIZE] >> (pos % BSIZE)) & 1;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (tree_.empty())
+      throw "Not built yet: tree_";
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    uint64_t sb = pos / MUTABLE_SB_SZ;
+    uint64_t r = prefix(sb);
+    for (size_t w = sb * MUTABLE_SB_BNUM; w < pos / BSIZE; w++)
+      r += popcount64(B_[w]);
+    if (pos % BSIZE != 0)
+      r += popcount64(B_[pos / BSIZE] &
+                      ((uint64_t(1) << (pos % BSIZE)) - 1));
+
+    return (bit)? r : pos - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (tree_.empty())
+      throw "Not built yet: tree_";
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? none_ : size_ - none_))
+      throw "Invalid input: pos";
+
+    /* The last superblock whose count before it <= pos */
+    uint64_t sb = 0;
+    for (uint64_t step = top_; step > 0; step /= 2) {
+      if (sb + step > nsb_)
+        continue;
+
+      uint64_t n = tree_[sb + step];
+      if (!bit)
+        n = step * MUTABLE_SB_SZ - n;
+
+      if (n <= pos) {
+        sb += step;
+        pos -= n;
+      }
+    }
+
+    for (size_t w = sb * MUTABLE_SB_BNUM;; w++) {
+      block_t blk = (bit)? B_[w] : ~B_[w];
+      uint64_t n = popcount64(blk);
+      if (pos < n)
+        return w * BSIZE + selectPos(blk, pos);
+      pos -= n;
+    }
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  /*
+   * Copy the blocks into sbv, and build it for static queries.
+   * B_ has the same word alignment as BitVector, and no ones
+   * beyond size_, so the blocks are copied as they are.
+   */
+  void freeze(SuccinctBitVector& sbv) const {
+    if (tree_.empty())
+      throw "Not built yet: tree_";
+
+    sbv = SuccinctBitVector();
+    sbv.init(size_);
+
+    BitVector& bv = sbv.bv_;
+    std::copy(B_.begin(), B_.begin() + bv.B_.size(), bv.B_.begin());
+    bv.none_ = none_;
+
+    sbv.build();
+  }
+
+  /* The size of the blocks and the tree in bytes */
+  uint64_t space() const {
+    return B_.size() * sizeof(block_t) + tree_.size() * sizeof(uint64_t);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  /* The number of ones in the first sb superblocks */
+  uint64_t prefix(uint64_t sb) const {
+    uint64_t r = 0;
+    for (uint64_t i = sb; i > 0; i -= i & -i)
+      r += tree_[i];
+    return r;
+  }
+
+  uint64_t  size_;
+  uint64_t  none_;
+
+  /* The number of superblocks, and the largest power of 2 in it */
+  uint64_t  nsb_;
+  uint64_t  top_;
+
+  std::vector<block_t>  B_;
+  std::vector<uint64_t> tree_;
+}; /* MutableSuccinctBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __MUTABLESUCCINCTBITVECTOR_HPP__ */
@@ -0,0 +1,454 @@
+/*-----------------------------------------------------------------------------
+ *  PagedSuccinctBitVector.hpp - A rank/select dictionary on compressed pages
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __PAGEDSUCCINCTBITVECTOR_HPP__
+#define __PAGEDSUCCINCTBITVECTOR_HPP__
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "SuccinctBitVector.hpp"
+#include "PosixIO.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * A paged file consists of groups of rBlocks compressed one by
+ * one, a directory of gEntrys (one per group and a sentinel),
+ * and gHeader at the tail. Only the directory stays resident;
+ * groups are decoded on demand into an LRU cache.
+ */
+static const uint64_t PAGED_MAGIC = 0x3167706363637573ULL;
+static const uint64_t PAGED_VERSION = 1;
+static const uint64_t PAGED_GROUP_SZ = 256;
+
+/* Encodings of a group */
+enum {
+  PG_RAW = 0,
+  PG_ONES,
+  PG_ZEROS
+};
+
+typedef struct {
+  uint64_t  magic;
+  uint64_t  version;
+  uint64_t  size;
+  uint64_t  none;
+  uint64_t  group_sz;
+  uint64_t  ngroups;
+  uint64_t  dir_off;
+} gHeader;
+
+typedef struct {
+  uint64_t  off;
+  uint64_t  rk;
+} gEntry;
+
+class PagedSuccinctBitVector {
+ public:
+  explicit PagedSuccinctBitVector(size_t cache_sz = 64) :
+      fd_(-1), cache_sz_(std::max(cache_sz, size_t(1))) {
+    memset(&hdr_, 0x00, sizeof(hdr_));
+  }
+
+  ~PagedSuccinctBitVector() throw() {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  /*
+   * Write bv as groups of group_sz rBlocks. Each group is kept
+   * in raw or as gaps between the minority bits, whichever
+   * is smaller.
+   */
+  static void write(const BitVector& bv, std::ostream& os,
+                    uint64_t group_sz = PAGED_GROUP_SZ) {
+    if (bv.length() == 0)
+      throw "Not initialized yet: bv";
+    if (group_sz == 0)
+      throw "Invalid input: group_sz";
+
+    uint64_t gbits = group_sz * PRESUM_SZ;
+
+    gHeader hdr;
+    hdr.magic = PAGED_MAGIC;
+    hdr.version = PAGED_VERSION;
+    hdr.size = bv.length();
+    hdr.none = 0;
+    hdr.group_sz = group_sz;
+    hdr.ngroups = (bv.length() + gbits - 1) / gbits;
+
+    std::vector<gEntry> dir;
+    std::vector<block_t> w(gbits / BSIZE);
+    std::string buf;
+
+    uint64_t off = 0;
+    for (uint64_t g = 0; g < hdr.ngroups; g++) {
+      uint64_t nbits = std::min(gbits, bv.length() - g * gbits);
+      uint64_t ones = 0;
+
+      for (uint64_t i = 0; i < w.size(); i++) {
+        uint64_t bidx = g * w.size() + i;
+        w[i] = (bidx < bv.bsize())? bv.get_block(bidx) : 0;
+        ones += popcount64(w[i]);
+      }
+
+      gEntry e = {off, hdr.none};
+      dir.push_back(e);
+
+      encode(w.data(), nbits, ones, buf);
+      os.write(buf.data(), buf.size());
+
+      off += buf.size();
+      hdr.none += ones;
+    }
+
+    gEntry e = {off, hdr.none};
+    dir.push_back(e);
+
+    hdr.dir_off = off;
+    os.write(reinterpret_cast<const char *>(dir.data()),
+             dir.size() * sizeof(gEntry));
+    os.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+    if (!os)
+      throw "Failed to write: os";
+  }
+
+  /* Open a paged file, reading its directory only */
+  void open(const char *path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      throw "Failed to open: path";
+
+    try {
+      struct stat st;
+      if (fstat(fd, &st) != 0 ||
+          static_cast<uint64_t>(st.st_size) < sizeof(gHeader))
+        throw "Corrupted data: fd";
+
+      gHeader hdr;
+      pread_full(fd, reinterpret_cast<char *>(&hdr), sizeof(hdr),
+                 st.st_size - sizeof(hdr));
+
+      uint64_t dsz = (hdr.ngroups + 1) * sizeof(gEntry);
+      if (hdr.magic != PAGED_MAGIC || hdr.version != PAGED_VERSION ||
+          hdr.size == 0 || hdr.group_sz == 0 ||
+          hdr.ngroups != (hdr.size + hdr.group_sz * PRESUM_SZ - 1) /
+              (hdr.group_sz * PRESUM_SZ) ||
+          hdr.dir_off + dsz + sizeof(hdr) !=
+              static_cast<uint64_t>(st.st_size))
+        throw "Corrupted data: header";
+
+      std::vector<gEntry> dir(hdr.ngroups + 1);
+      pread_full(fd, reinterpret_cast<char *>(dir.data()), dsz,
+                 hdr.dir_off);
+      check_dir(hdr, dir);
+
+      std::lock_guard<std::mutex> lk(mtx_);
+      if (fd_ >= 0)
+        close(fd_);
+
+      fd_ = fd, hdr_ = hdr, dir_.swap(dir);
+      lru_.clear(), cache_.clear();
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= hdr_.size)
+      throw "Invalid input: pos";
+
+    GroupPtr grp = fetch(pos / gbits());
+    const rBlock& rblk = (*grp)[pos % gbits() / PRESUM_SZ];
+    block_t blk = (pos & BSIZE)? rblk.b1 : rblk.b0;
+    return (blk & (uint64_t(1) << (pos % BSIZE))) > 0;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= hdr_.size)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    uint64_t g = pos / gbits();
+    uint64_t r = dir_[g].rk;
+
+    if (pos % gbits() != 0) {
+      GroupPtr grp = fetch(g);
+      r += rblock_rank1((*grp)[pos % gbits() / PRESUM_SZ], pos);
+    }
+
+    return (bit)? r : pos - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? hdr_.none : hdr_.size - hdr_.none))
+      throw "Invalid input: pos";
+
+    /* Find the last group whose cumulative count <= pos */
+    uint64_t lo = 0;
+    uint64_t hi = hdr_.ngroups - 1;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo + 1) / 2;
+      if (cumltv(mid, bit) <= pos)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    pos -= cumltv(lo, bit);
+
+    GroupPtr grp = fetch(lo);
+    const std::vector<rBlock>& rblk = *grp;
+
+    uint64_t rpos = rblock_search(rblk.data(), 0,
+                                  rblk.size() - 1, pos, bit);
+    uint64_t rem = pos - rblock_cumltv(rblk[rpos], rpos, bit);
+
+    return lo * gbits() + rpos * PRESUM_SZ +
+        rblock_select(rblk[rpos], rem, bit);
+  }
+
+  uint64_t length() const {
+    return hdr_.size;
+  }
+
+  uint64_t get_none() const {
+    return hdr_.none;
+  }
+
+  /* The number of groups decoded in the cache */
+  size_t cached() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return cache_.size();
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  typedef std::list<uint64_t> LRUList;
+  typedef std::shared_ptr<const std::vector<rBlock> > GroupPtr;
+  typedef std::pair<LRUList::iterator, GroupPtr> CacheEntry;
+
+  uint64_t gbits() const {
+    return hdr_.group_sz * PRESUM_SZ;
+  }
+
+  uint64_t cumltv(uint64_t g, uint8_t bit) const {
+    return (bit)? dir_[g].rk : g * gbits() - dir_[g].rk;
+  }
+
+  /*
+   * Return the decoded group g. The lock is only held to look up
+   * and update the cache, so a miss reads and decodes the group
+   * while queries on the other groups go on. A group evicted in
+   * the meantime stays alive while it is referred.
+   */
+  GroupPtr fetch(uint64_t g) const {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      GroupPtr grp = find_group(g);
+      if (grp)
+        return grp;
+    }
+
+    std::string buf(dir_[g + 1].off - dir_[g].off, '\0');
+    pread_full(fd_, &buf[0], buf.size(), dir_[g].off);
+
+    std::vector<rBlock> rblk;
+    uint64_t nbits = std::min(gbits(), hdr_.size - g * gbits());
+    decode(buf, hdr_.group_sz, nbits, rblk);
+
+    std::lock_guard<std::mutex> lk(mtx_);
+
+    /* Another thread may have decoded the group first */
+    GroupPtr grp = find_group(g);
+    if (grp)
+      return grp;
+
+    if (cache_.size() >= cache_sz_) {
+      cache_.erase(lru_.back());
+      lru_.pop_back();
+    }
+
+    std::shared_ptr<std::vector<rBlock> > dec(new std::vector<rBlock>());
+    dec->swap(rblk);
+
+    lru_.push_front(g);
+    CacheEntry& e = cache_[g];
+    e.first = lru_.begin();
+    e.second = dec;
+
+    return e.second;
+  }
+
+  /* Look up a group in the cache, which must be called locked */
+  GroupPtr find_group(uint64_t g) const {
+    std::unordered_map<uint64_t, CacheEntry>::iterator it =
+        cache_.find(g);
+    if (it == cache_.end())
+      return GroupPtr();
+
+    lru_.splice(lru_.begin(), lru_, it->second.first);
+    return it->second.second;
+  }
+
+  /*
+   * Groups are laid out in order before the directory, and hold
+   * at most gbits ones each, so every offset and count must be
+   * non-decreasing and end at the directory and at none.
+   */
+  static void check_dir(const gHeader& hdr,
+                        const std::vector<gEntry>& dir) {
+    uint64_t gbits = hdr.group_sz * PRESUM_SZ;
+    if (dir[0].off != 0 || dir[0].rk != 0 ||
+        dir[hdr.ngroups].off != hdr.dir_off ||
+        dir[hdr.ngroups].rk != hdr.none)
+      throw "Corrupted data: directory";
+
+    for (uint64_t g = 0; g < hdr.ngroups; g++) {
+      if (dir[g + 1].off <= dir[g].off ||
+          dir[g + 1].rk < dir[g].rk ||
+          dir[g + 1].rk - dir[g].rk > gbits)
+        throw "Corrupted data: directory";
+    }
+  }
+
+  static void put_varint(uint64_t v, std::string& out) {
+    while (v >= 0x80) {
+      out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+      v >>= 7;
+    }
+
+    out.push_back(static_cast<char>(v));
+  }
+
+  static uint64_t get_varint(const std::string& in, size_t& i) {
+    uint64_t v = 0;
+    for (int shift = 0; i < in.size() && shift < 64; shift += 7) {
+      uint8_t c = in[i++];
+      v |= static_cast<uint64_t>(c & 0x7f) << shift;
+      if (!(c & 0x80))
+        return v;
+    }
+
+    throw "Corrupted data: varint";
+  }
+
+  static void encode(const block_t *w, uint64_t nbits,
+                     uint64_t ones, std::string& out) {
+    uint64_t nw = (nbits + BSIZE - 1) / BSIZE;
+    uint8_t bit = (ones <= nbits - ones)? 1 : 0;
+
+    out.clear();
+    out.push_back(static_cast<char>((bit)? PG_ONES : PG_ZEROS));
+
+    uint64_t prev = 0;
+    for (uint64_t i = 0; i < nw && out.size() <= nw * sizeof(block_t); i++) {
+      block_t blk = (bit)? w[i] : ~w[i];
+      if (i == nw - 1 && nbits % BSIZE != 0)
+        blk &= (uint64_t(1) << (nbits % BSIZE)) - 1;
+
+      while (blk) {
+        uint64_t p = i * BSIZE + __builtin_ctzll(blk);
+        put_varint(p - prev, out);
+        prev = p + 1;
+        blk &= blk - 1;
+      }
+    }
+
+    /* Fall back to raw if gaps are not smaller */
+    if (out.size() > nw * sizeof(block_t)) {
+      out.clear();
+      out.push_back(static_cast<char>(PG_RAW));
+      out.append(reinterpret_cast<const char *>(w),
+                 nw * sizeof(block_t));
+    }
+  }
+
+  static void decode(const std::string& in, uint64_t group_sz,
+                     uint64_t nbits, std::vector<rBlock>& rblk) {
+    uint64_t nw = (nbits + BSIZE - 1) / BSIZE;
+    std::vector<block_t> w(group_sz * PRESUM_SZ / BSIZE, 0);
+
+    if (in.empty())
+      throw "Corrupted data: group";
+
+    if (in[0] == PG_RAW) {
+      if (in.size() != 1 + nw * sizeof(block_t))
+        throw "Corrupted data: group";
+      memcpy(w.data(), in.data() + 1, nw * sizeof(block_t));
+    } else if (in[0] == PG_ONES || in[0] == PG_ZEROS) {
+      block_t fill = (in[0] == PG_ONES)? 0 : uint64_t(-1);
+      for (uint64_t i = 0; i < nw; i++)
+        w[i] = fill;
+
+      size_t i = 1;
+      uint64_t p = 0;
+      while (i < in.size()) {
+        p += get_varint(in, i);
+        if (p >= nbits)
+          throw "Corrupted data: group";
+
+        w[p / BSIZE] ^= uint64_t(1) << (p % BSIZE);
+        p++;
+      }
+
+      if (nbits % BSIZE != 0)
+        w[nw - 1] &= (uint64_t(1) << (nbits % BSIZE)) - 1;
+    } else {
+      throw "Corrupted data: group";
+    }
+
+    rblk.resize(group_sz);
+    for (uint64_t i = 0; i < group_sz; i++) {
+      rblk[i].b0 = w[2 * i];
+      rblk[i].b1 = w[2 * i + 1];
+    }
+
+    rblock_build(rblk.data(), rblk.size());
+  }
+
+  int       fd_;
+  size_t    cache_sz_;
+  gHeader   hdr_;
+
+  /* A resident directory of groups */
+  std::vector<gEntry> dir_;
+
+  /* An LRU cache of decoded groups */
+  mutable LRUList     lru_;
+  mutable std::unordered_map<uint64_t, CacheEntry> cache_;
+  mutable std::mutex  mtx_;
+
+  PagedSuccinctBitVector(const PagedSuccinctBitVector&);
+  PagedSuccinctBitVector& operator=(const PagedSuccinctBitVector&);
+}; /* PagedSuccinctBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __PAGEDSUCCINCTBITVECTOR_HPP__ */
@@ -0,0 +1,41 @@
+/*-----------------------------------------------------------------------------
+ *  PosixIO.hpp - Helpers for positional file I/O
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __POSIXIO_HPP__
+#define __POSIXIO_HPP__
+
+#include <cstdlib>
+#include <cstdint>
+
+#include <unistd.h>
+#include <errno.h>
+
+namespace succinct {
+
+/* Read len bytes at off, retrying short reads */
+static inline void pread_full(int fd, char *buf,
+                              size_t len, uint64_t off) {
+  while (len > 0) {
+    ssize_t r = pread(fd, buf, len, off);
+
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r < 0)
+      throw "Failed to read: fd";
+    if (r == 0)
+      throw "Corrupted data: fd";
+
+    buf += r, len -= r, off += r;
+  }
+}
+
+} /* succinct */
+
+#endif /* __POSIXIO_HPP__ */
@@ -0,0 +1,183 @@
+/*-----------------------------------------------------------------------------
+ *  RLESuccinctBitVector.hpp - A rank/select dictionary over runs of ones
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __RLESUCCINCTBITVECTOR_HPP__
+#define __RLESUCCINCTBITVECTOR_HPP__
+
+#include <utility>
+#include <vector>
+
+#include "SparseSuccinctBitVector.hpp"
+
+namespace succinct {
+namespace rle {
+
+/*
+ * SuccinctBitVector with run-length encoding: the bits are runs
+ * of ones separated by runs of zeros. The starts of the runs of
+ * ones are kept in a sparse vector over the positions, and the
+ * last one of each run is kept in another sparse vector over the
+ * ones, so space and time depend on the number of runs, not on
+ * length().
+ */
+class SuccinctBitVector {
+ public:
+  SuccinctBitVector() : size_(0), none_(0), nruns_(0) {}
+  ~SuccinctBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    if (size == 0)
+      throw "Invalid input: size";
+
+    size_ = size;
+    none_ = 0;
+    runs_.clear();
+  }
+
+  /* Add ones in [pos, pos + len), after the last ones added */
+  void add_run(uint64_t pos, uint64_t len) {
+    if (len == 0 || pos + len > size_ || pos + len < pos)
+      throw "Invalid input: len";
+    if (!runs_.empty() && pos < runs_.back().first + runs_.back().second)
+      throw "Invalid input: pos";
+
+    /* Adjacent runs are merged */
+    if (!runs_.empty() && pos == runs_.back().first + runs_.back().second)
+      runs_.back().second += len;
+    else
+      runs_.push_back(std::make_pair(pos, len));
+
+    none_ += len;
+  }
+
+  void build() {
+    if (size_ == 0)
+      throw "Not initialized yet: size_";
+
+    nruns_ = runs_.size();
+    start_ = sparse::SuccinctBitVector();
+    end_ = sparse::SuccinctBitVector();
+
+    start_.init(size_);
+    if (none_ != 0)
+      end_.init(none_);
+
+    uint64_t r = 0;
+    for (size_t j = 0; j < runs_.size(); j++) {
+      start_.add(runs_[j].first);
+      r += runs_[j].second;
+      end_.add(r - 1);
+    }
+
+    start_.build();
+    if (none_ != 0)
+      end_.build();
+
+    std::vector<std::pair<uint64_t, uint64_t> >().swap(runs_);
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    uint64_t j = start_.rank(pos, 1);
+    return j > 0 && pos < start_.select(j - 1, 1) + run_len(j - 1);
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    /* The runs starting at pos or before */
+    uint64_t j = start_.rank(pos, 1);
+
+    uint64_t r = 0;
+    if (j > 0) {
+      uint64_t s = start_.select(j - 1, 1);
+      r = ones_before(j - 1) + std::min(pos - s + 1, run_len(j - 1));
+    }
+
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? none_ : size_ - none_))
+      throw "Invalid input: pos";
+
+    if (bit) {
+      /* The run ending at pos or after */
+      uint64_t j = (pos)? end_.rank(pos - 1, 1) : 0;
+      return start_.select(j, 1) + pos - ones_before(j);
+    }
+
+    /* The number of runs before the pos-th zero */
+    uint64_t lo = 0;
+    uint64_t hi = nruns_;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (start_.select(mid, 1) - ones_before(mid) <= pos)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return pos + ones_before(lo);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  /* The number of runs of ones */
+  uint64_t run_num() const {
+    return nruns_;
+  }
+
+  /* The size of the encoded data in bytes */
+  uint64_t space() const {
+    return start_.space() + ((none_)? end_.space() : 0);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  uint64_t ones_before(uint64_t j) const {
+    return (j)? end_.select(j - 1, 1) + 1 : 0;
+  }
+
+  uint64_t run_len(uint64_t j) const {
+    return ones_before(j + 1) - ones_before(j);
+  }
+
+  uint64_t  size_;
+  uint64_t  none_;
+  uint64_t  nruns_;
+
+  /* Runs added until build() */
+  std::vector<std::pair<uint64_t, uint64_t> > runs_;
+
+  /* The starts of runs, and the last ones of runs in ones */
+  sparse::SuccinctBitVector start_;
+  sparse::SuccinctBitVector end_;
+}; /* SuccinctBitVector */
+
+} /* rle */
+} /* succinct */
+
+#endif /* __RLESUCCINCTBITVECTOR_HPP__ */
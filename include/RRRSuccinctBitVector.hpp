@@ -0,0 +1,317 @@
+/*-----------------------------------------------------------------------------
+ *  RRRSuccinctBitVector.hpp - A compressed rank/select dictionary with RRR
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __RRRSUCCINCTBITVECTOR_HPP__
+#define __RRRSUCCINCTBITVECTOR_HPP__
+
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace rrr {
+
+using dense::block_t;
+using dense::BSIZE;
+using dense::popcount64;
+using dense::selectPos;
+using dense::get_bits;
+using dense::put_bits;
+
+static const size_t RRR_BLOCK_SZ = 63;
+static const size_t RRR_SAMPLE_SZ = 32;
+
+/* Binomial coefficients C(n, k) for n < BSIZE */
+static const uint64_t *binomials() {
+  static struct Table {
+    uint64_t c[BSIZE][BSIZE];
+    Table() {
+      memset(c, 0x00, sizeof(c));
+      for (size_t n = 0; n < BSIZE; n++) {
+        c[n][0] = 1;
+        for (size_t k = 1; k <= n; k++)
+          c[n][k] = c[n - 1][k - 1] + ((k < n)? c[n - 1][k] : 0);
+      }
+    }
+  } table;
+
+  return &table.c[0][0];
+}
+
+static inline uint64_t binomial(size_t n, size_t k) {
+  return (k <= n)? binomials()[n * BSIZE + k] : 0;
+}
+
+/* The number of bits to keep an offset in class k */
+static inline size_t offset_width(size_t bsz, size_t k) {
+  uint64_t c = binomial(bsz, k);
+  return (c > 1)? BSIZE - __builtin_clzll(c - 1) : 0;
+}
+
+/*
+ * SuccinctBitVector with RRR: bits are divided into blocks of
+ * block_sz (< BSIZE) bits, and each block is kept as its class
+ * (the number of ones) and its offset among the blocks in the
+ * class. The offsets are coded with binomial coefficients and
+ * decoded on the fly. Every RRR_SAMPLE_SZ blocks, the number
+ * of ones and the position in the offsets are sampled. A larger
+ * block_sz saves space for skewed bits and slows decoding.
+ */
+class SuccinctBitVector {
+ public:
+  SuccinctBitVector() : size_(0), none_(0), bsz_(RRR_BLOCK_SZ),
+      cwidth_(0) {}
+  ~SuccinctBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size, size_t block_sz = RRR_BLOCK_SZ) {
+    if (size == 0)
+      throw "Invalid input: size";
+    if (block_sz == 0 || block_sz >= BSIZE)
+      throw "Invalid input: block_sz";
+
+    bv_.init(size);
+    size_ = size;
+    bsz_ = block_sz;
+  }
+
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (pos >= bv_.length())
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    bv_.set_bit(pos, bit);
+  }
+
+  /* Encode the bits, which are released after that */
+  void build() {
+    if (bv_.length() == 0)
+      throw "Not initialized yet: bv_";
+
+    cwidth_ = BSIZE - __builtin_clzll(bsz_);
+
+    uint64_t nblocks = (size_ + bsz_ - 1) / bsz_;
+    cls_.assign((nblocks * cwidth_ + BSIZE - 1) / BSIZE + 1, 0);
+    off_.assign(1, 0);
+    rk_.clear();
+    ptr_.clear();
+
+    uint64_t r = 0;
+    uint64_t optr = 0;
+    for (uint64_t i = 0; i < nblocks; i++) {
+      if (i % RRR_SAMPLE_SZ == 0) {
+        rk_.push_back(r);
+        ptr_.push_back(optr);
+      }
+
+      block_t blk = read_bits(i * bsz_, block_len(i));
+      size_t k = popcount64(blk);
+
+      put_bits(cls_.data(), i * cwidth_, cwidth_, k);
+
+      size_t w = offset_width(bsz_, k);
+      off_.resize((optr + w + BSIZE - 1) / BSIZE + 1, 0);
+      put_bits(off_.data(), optr, w, encode(blk, k));
+
+      r += k;
+      optr += w;
+    }
+
+    /* A sentinel to bound the last search */
+    rk_.push_back(r);
+    ptr_.push_back(optr);
+
+    none_ = r;
+    bv_ = dense::BitVector();
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    block_t blk = block(pos / bsz_);
+    return (blk >> (pos % bsz_)) & 1;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    uint64_t bidx = pos / bsz_;
+    uint64_t r = 0;
+    uint64_t optr = 0;
+    skip(bidx, r, optr);
+
+    if (pos % bsz_ != 0) {
+      size_t k = get_class(bidx);
+      block_t blk = decode(optr, k);
+      r += popcount64(blk & ((uint64_t(1) << (pos % bsz_)) - 1));
+    }
+
+    return (bit)? r : pos - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? none_ : size_ - none_))
+      throw "Invalid input: pos";
+
+    /* Find the last sample whose cumulative count <= pos */
+    uint64_t lo = 0;
+    uint64_t hi = rk_.size() - 2;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo + 1) / 2;
+      if (cumltv(mid, bit) <= pos)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    uint64_t rem = pos - cumltv(lo, bit);
+    uint64_t optr = ptr_[lo];
+    uint64_t bidx = lo * RRR_SAMPLE_SZ;
+
+    for (;; bidx++) {
+      size_t k = get_class(bidx);
+      size_t n = (bit)? k : block_len(bidx) - k;
+      if (rem < n) {
+        block_t blk = decode(optr, k);
+        return bidx * bsz_ + selectPos((bit)? blk : ~blk, rem);
+      }
+
+      rem -= n;
+      optr += offset_width(bsz_, k);
+    }
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  size_t block_size() const {
+    return bsz_;
+  }
+
+  /* The size of the encoded data in bytes */
+  uint64_t space() const {
+    return (cls_.size() + off_.size() + rk_.size() + ptr_.size()) *
+        sizeof(uint64_t);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  /* Read w bits at pos from the bits before build() */
+  block_t read_bits(uint64_t pos, size_t w) const {
+    uint64_t i = pos / BSIZE;
+    size_t d = pos % BSIZE;
+
+    block_t blk = bv_.get_block(i) >> d;
+    if (d + w > BSIZE)
+      blk |= bv_.get_block(i + 1) << (BSIZE - d);
+
+    return blk & ((uint64_t(1) << w) - 1);
+  }
+
+  /* The offset of blk among the blocks with k ones */
+  uint64_t encode(block_t blk, size_t k) const {
+    uint64_t off = 0;
+    for (size_t i = 0; i < bsz_ && k > 0; i++) {
+      if (blk & (uint64_t(1) << i)) {
+        off += binomial(bsz_ - i - 1, k);
+        k--;
+      }
+    }
+
+    return off;
+  }
+
+  /* Decode the block of class k whose offset is at optr */
+  block_t decode(uint64_t optr, size_t k) const {
+    uint64_t off = get_bits(off_.data(), optr, offset_width(bsz_, k));
+    block_t blk = 0;
+    for (size_t i = 0; i < bsz_ && k > 0; i++) {
+      uint64_t c = binomial(bsz_ - i - 1, k);
+      if (off >= c) {
+        blk |= uint64_t(1) << i;
+        off -= c;
+        k--;
+      }
+    }
+
+    return blk;
+  }
+
+  size_t get_class(uint64_t bidx) const {
+    return get_bits(cls_.data(), bidx * cwidth_, cwidth_);
+  }
+
+  uint64_t block_len(uint64_t bidx) const {
+    return std::min(uint64_t(bsz_), size_ - bidx * bsz_);
+  }
+
+  /* Accumulate ones and offset widths before the bidx-th block */
+  void skip(uint64_t bidx, uint64_t& r, uint64_t& optr) const {
+    uint64_t s = bidx / RRR_SAMPLE_SZ;
+    r = rk_[s];
+    optr = ptr_[s];
+
+    for (uint64_t i = s * RRR_SAMPLE_SZ; i < bidx; i++) {
+      size_t k = get_class(i);
+      r += k;
+      optr += offset_width(bsz_, k);
+    }
+  }
+
+  block_t block(uint64_t bidx) const {
+    uint64_t r = 0;
+    uint64_t optr = 0;
+    skip(bidx, r, optr);
+
+    size_t k = get_class(bidx);
+    return decode(optr, k);
+  }
+
+  uint64_t cumltv(uint64_t s, uint8_t bit) const {
+    return (bit)? rk_[s] :
+        std::min(s * RRR_SAMPLE_SZ * bsz_, size_) - rk_[s];
+  }
+
+  uint64_t  size_;
+  uint64_t  none_;
+  size_t    bsz_;
+  size_t    cwidth_;
+
+  /* Bits kept until build() */
+  dense::BitVector bv_;
+
+  /* Classes in cwidth_ bits and offsets in variable bits */
+  std::vector<block_t>  cls_;
+  std::vector<block_t>  off_;
+
+  /* Ones and positions in off_ sampled by RRR_SAMPLE_SZ blocks */
+  std::vector<uint64_t> rk_;
+  std::vector<uint64_t> ptr_;
+}; /* SuccinctBitVector */
+
+} /* rrr */
+} /* succinct */
+
+#endif /* __RRRSUCCINCTBITVECTOR_HPP__ */
@@ -0,0 +1,321 @@
+/*-----------------------------------------------------------------------------
+ *  ShardedSuccinctBitVector.hpp - A rank/select dictionary split into shards
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __SHARDEDSUCCINCTBITVECTOR_HPP__
+#define __SHARDEDSUCCINCTBITVECTOR_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <ostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "SuccinctBitVector.hpp"
+#include "SuccinctBitVectorLoader.hpp"
+#include "PosixIO.hpp"
+#include "ThreadPool.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * A sharded file consists of the shards saved by
+ * SuccinctBitVector::save(), a directory of shEntrys (one per
+ * shard and a sentinel), and shHeader at the tail.
+ */
+static const uint64_t SHARDED_MAGIC = 0x3168736363637573ULL;
+static const uint64_t SHARDED_VERSION = 1;
+static const uint64_t SHARD_SZ = 1 << 20;
+
+typedef struct {
+  uint64_t  magic;
+  uint64_t  version;
+  uint64_t  size;
+  uint64_t  none;
+  uint64_t  shard_sz;
+  uint64_t  nshards;
+  uint64_t  dir_off;
+} shHeader;
+
+typedef struct {
+  uint64_t  off;
+  uint64_t  rk;
+} shEntry;
+
+/*
+ * ShardedSuccinctBitVector splits the bits into shards of
+ * shard_sz bits, each of which is a SuccinctBitVector of its
+ * own, and keeps the number of ones before each shard in a
+ * small table. Shards are built in parallel, and a file opened
+ * lazily reads a shard on its first access.
+ */
+class ShardedSuccinctBitVector {
+ public:
+  ShardedSuccinctBitVector() : size_(0), shard_sz_(SHARD_SZ), fd_(-1) {}
+  ~ShardedSuccinctBitVector() throw() {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  /* Functions to initialize */
+  void init(uint64_t size, uint64_t shard_sz = SHARD_SZ) {
+    if (size == 0)
+      throw "Invalid input: size";
+    if (shard_sz == 0)
+      throw "Invalid input: shard_sz";
+
+    size_ = size;
+    shard_sz_ = shard_sz;
+
+    uint64_t nshards = (size + shard_sz - 1) / shard_sz;
+    reset(nshards, true);
+
+    for (uint64_t s = 0; s < nshards; s++)
+      shards_[s].init(std::min(shard_sz, size - s * shard_sz));
+  }
+
+  /* Build all the shards with nthreads */
+  void build(size_t nthreads = 1) {
+    if (size_ == 0)
+      throw "Not initialized yet: size_";
+
+    ThreadPool tp(std::min(nthreads, shards_.size()));
+    tp.run(shards_.size(), [&](size_t s) {
+      shards_[s].build();
+    });
+
+    for (size_t s = 0; s < shards_.size(); s++)
+      prefix_[s + 1] = prefix_[s] + shards_[s].get_none();
+  }
+
+  void set_bit(uint64_t pos, uint8_t bit) {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    shard(pos / shard_sz_).set_bit(pos % shard_sz_, bit);
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    return shard(pos / shard_sz_).lookup(pos % shard_sz_);
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t s = pos / shard_sz_;
+    return cumltv(s, bit) + shard(s).rank(pos % shard_sz_, bit);
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= cumltv(shards_.size(), bit))
+      throw "Invalid input: pos";
+
+    /* Find the last shard whose cumulative count <= pos */
+    uint64_t lo = 0;
+    uint64_t hi = shards_.size() - 1;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo + 1) / 2;
+      if (cumltv(mid, bit) <= pos)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    return lo * shard_sz_ +
+        shard(lo).select(pos - cumltv(lo, bit), bit);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return prefix_.empty()? 0 : prefix_.back();
+  }
+
+  uint64_t shard_num() const {
+    return shards_.size();
+  }
+
+  /* The number of shards in memory */
+  uint64_t loaded() const {
+    uint64_t n = 0;
+    for (size_t s = 0; s < shards_.size(); s++)
+      n += loaded_[s].load(std::memory_order_acquire);
+    return n;
+  }
+
+  /* Functions to serialize */
+  void save(std::ostream& os, bool with_select = true) const {
+    std::streampos base = os.tellp();
+    if (base == std::streampos(-1))
+      throw "Invalid input: os";
+
+    std::vector<shEntry> dir;
+    for (size_t s = 0; s < shards_.size(); s++) {
+      shEntry e = {static_cast<uint64_t>(os.tellp() - base), prefix_[s]};
+      dir.push_back(e);
+      shard(s).save(os, with_select);
+    }
+
+    shEntry e = {static_cast<uint64_t>(os.tellp() - base), get_none()};
+    dir.push_back(e);
+
+    shHeader hdr;
+    hdr.magic = SHARDED_MAGIC;
+    hdr.version = SHARDED_VERSION;
+    hdr.size = size_;
+    hdr.none = get_none();
+    hdr.shard_sz = shard_sz_;
+    hdr.nshards = shards_.size();
+    hdr.dir_off = e.off;
+
+    os.write(reinterpret_cast<const char *>(dir.data()),
+             dir.size() * sizeof(shEntry));
+    os.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+    if (!os)
+      throw "Failed to write: os";
+  }
+
+  /*
+   * Open a sharded file. Shards are read on their first access
+   * if lazy, or all at once with nthreads otherwise.
+   */
+  void open(const char *path, bool lazy = true, size_t nthreads = 1) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      throw "Failed to open: path";
+
+    try {
+      struct stat st;
+      if (fstat(fd, &st) != 0 ||
+          static_cast<uint64_t>(st.st_size) < sizeof(shHeader))
+        throw "Corrupted data: fd";
+
+      shHeader hdr;
+      pread_full(fd, reinterpret_cast<char *>(&hdr), sizeof(hdr),
+                 st.st_size - sizeof(hdr));
+
+      uint64_t dsz = (hdr.nshards + 1) * sizeof(shEntry);
+      if (hdr.magic != SHARDED_MAGIC || hdr.version != SHARDED_VERSION ||
+          hdr.size == 0 || hdr.shard_sz == 0 ||
+          hdr.nshards != (hdr.size + hdr.shard_sz - 1) / hdr.shard_sz ||
+          hdr.dir_off + dsz + sizeof(hdr) !=
+              static_cast<uint64_t>(st.st_size))
+        throw "Corrupted data: header";
+
+      std::vector<shEntry> dir(hdr.nshards + 1);
+      pread_full(fd, reinterpret_cast<char *>(dir.data()), dsz,
+                 hdr.dir_off);
+
+      if (fd_ >= 0)
+        close(fd_);
+
+      fd_ = fd;
+      size_ = hdr.size;
+      shard_sz_ = hdr.shard_sz;
+      reset(hdr.nshards, false);
+
+      off_.resize(hdr.nshards);
+      for (uint64_t s = 0; s < hdr.nshards; s++) {
+        off_[s] = dir[s].off;
+        prefix_[s] = dir[s].rk;
+      }
+
+      prefix_[hdr.nshards] = dir[hdr.nshards].rk;
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+
+    if (!lazy) {
+      ThreadPool tp(std::min(nthreads, shards_.size()));
+      tp.run(shards_.size(), [&](size_t s) {
+        load_shard(s);
+      });
+    }
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  void reset(uint64_t nshards, bool loaded) {
+    shards_.clear();
+    shards_.resize(nshards);
+    prefix_.assign(nshards + 1, 0);
+    off_.clear();
+
+    loaded_.reset(new std::atomic<bool>[nshards]);
+    for (uint64_t s = 0; s < nshards; s++)
+      loaded_[s].store(loaded);
+  }
+
+  uint64_t cumltv(uint64_t s, uint8_t bit) const {
+    return (bit)? prefix_[s] :
+        std::min(s * shard_sz_, size_) - prefix_[s];
+  }
+
+  /* Return the s-th shard, reading it if not loaded yet */
+  SuccinctBitVector& shard(uint64_t s) const {
+    if (!loaded_[s].load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lk(mtx_);
+
+      if (!loaded_[s].load(std::memory_order_relaxed))
+        load_shard(s);
+    }
+
+    return shards_[s];
+  }
+
+  void load_shard(uint64_t s) const {
+    SuccinctBitVectorLoader loader;
+    loader.load(fd_, shards_[s], false, off_[s]);
+
+    if (shards_[s].length() != std::min(shard_sz_, size_ - s * shard_sz_))
+      throw "Corrupted data: shard";
+
+    loaded_[s].store(true, std::memory_order_release);
+  }
+
+  uint64_t  size_;
+  uint64_t  shard_sz_;
+
+  /* The number of ones before each shard */
+  std::vector<uint64_t> prefix_;
+
+  mutable std::vector<SuccinctBitVector>      shards_;
+  std::unique_ptr<std::atomic<bool>[]>        loaded_;
+
+  /* An opened file and offsets of the shards in it */
+  int                     fd_;
+  std::vector<uint64_t>   off_;
+  mutable std::mutex      mtx_;
+
+  ShardedSuccinctBitVector(const ShardedSuccinctBitVector&);
+  ShardedSuccinctBitVector& operator=(const ShardedSuccinctBitVector&);
+}; /* ShardedSuccinctBitVector */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __SHARDEDSUCCINCTBITVECTOR_HPP__ */
@@ -0,0 +1,210 @@
+/*-----------------------------------------------------------------------------
+ *  SparseSuccinctBitVector.hpp - A rank/select dictionary with Elias-Fano
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __SPARSESUCCINCTBITVECTOR_HPP__
+#define __SPARSESUCCINCTBITVECTOR_HPP__
+
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+
+namespace succinct {
+namespace sparse {
+
+using dense::block_t;
+using dense::BSIZE;
+using dense::get_bits;
+using dense::put_bits;
+
+/*
+ * SuccinctBitVector with Elias-Fano: the positions of n ones in
+ * size bits are split into the lower l = log(size / n) bits and
+ * the rest. The lower bits are packed in an array, and the upper
+ * bits are kept in unary in a dense SuccinctBitVector of about
+ * 2n bits, the i-th one of which is at (pos_i >> l) + i. Select
+ * is a select on the upper bits, and rank and successor search
+ * the bucket of a position found by a select of zeros. So space
+ * depends on n, not on size.
+ */
+class SuccinctBitVector {
+ public:
+  SuccinctBitVector() : size_(0), none_(0), lw_(0) {}
+  ~SuccinctBitVector() throw() {}
+
+  /* Functions to initialize */
+  void init(uint64_t size) {
+    if (size == 0)
+      throw "Invalid input: size";
+
+    size_ = size;
+    pos_.clear();
+  }
+
+  /* Add a position of a one, larger than the last one */
+  void add(uint64_t pos) {
+    if (pos >= size_ || (!pos_.empty() && pos <= pos_.back()))
+      throw "Invalid input: pos";
+
+    pos_.push_back(pos);
+  }
+
+  void build() {
+    if (size_ == 0)
+      throw "Not initialized yet: size_";
+
+    /* With no ones, all the bits go to the lower part */
+    none_ = pos_.size();
+    uint64_t q = (none_)? size_ / none_ : size_;
+    lw_ = (q > 1)? BSIZE - 1 - __builtin_clzll(q) : 0;
+
+    low_.assign((none_ * lw_ + BSIZE - 1) / BSIZE + 1, 0);
+    high_ = dense::SuccinctBitVector();
+    high_.init(none_ + (size_ >> lw_) + 1);
+
+    for (uint64_t i = 0; i < none_; i++) {
+      put_bits(low_.data(), i * lw_, lw_, pos_[i]);
+      high_.set_bit((pos_[i] >> lw_) + i, 1);
+    }
+
+    high_.build();
+    std::vector<uint64_t>().swap(pos_);
+  }
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    uint64_t i = lower_bound(pos);
+    return i < none_ && get(i) == pos;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t r = lower_bound(pos + 1);
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= ((bit)? none_ : size_ - none_))
+      throw "Invalid input: pos";
+
+    if (bit)
+      return get(pos);
+
+    /* The number of ones before the pos-th zero */
+    uint64_t lo = 0;
+    uint64_t hi = none_;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (get(mid) - mid <= pos)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return pos + lo;
+  }
+
+  /* The first position of bit at pos or later, or length() */
+  uint64_t next(uint64_t pos, uint8_t bit) const {
+    if (pos > size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t i = lower_bound(pos);
+    if (bit)
+      return (i < none_)? get(i) : size_;
+
+    /*
+     * get(j) - j is not decreasing, and constant in a run of
+     * ones, so the end of the run from pos is searched.
+     */
+    uint64_t lo = i;
+    uint64_t hi = none_;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (get(mid) - mid <= pos - i)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return pos + (lo - i);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  /* The size of the encoded data in bytes */
+  uint64_t space() const {
+    uint64_t rblks = high_.length() / dense::PRESUM_SZ + 1;
+    return low_.size() * sizeof(block_t) + rblks * sizeof(dense::rBlock) +
+        (high_.length() + BSIZE - 1) / BSIZE * sizeof(block_t);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  /* The i-th position of ones */
+  uint64_t get(uint64_t i) const {
+    return ((high_.select(i, 1) - i) << lw_) |
+        get_bits(low_.data(), i * lw_, lw_);
+  }
+
+  /* The number of ones before pos */
+  uint64_t lower_bound(uint64_t pos) const {
+    if (pos >= size_)
+      return none_;
+
+    uint64_t h = pos >> lw_;
+    uint64_t low = pos & ((uint64_t(1) << lw_) - 1);
+
+    /* Ones in bucket h are in [lo, hi) */
+    uint64_t lo = (h)? high_.select(h - 1, 0) + 1 - h : 0;
+    uint64_t hi = high_.select(h, 0) - h;
+
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (get_bits(low_.data(), mid * lw_, lw_) < low)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return lo;
+  }
+
+  uint64_t  size_;
+  uint64_t  none_;
+  size_t    lw_;
+
+  /* Positions added until build() */
+  std::vector<uint64_t> pos_;
+
+  std::vector<block_t>        low_;
+  dense::SuccinctBitVector    high_;
+}; /* SuccinctBitVector */
+
+} /* sparse */
+} /* succinct */
+
+#endif /* __SPARSESUCCINCTBITVECTOR_HPP__ */
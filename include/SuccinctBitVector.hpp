@@ -21,8 +21,14 @@
 #include <climits>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <istream>
+#include <ostream>
 
 #include <nmmintrin.h>
+#if defined(__AVX2__) || defined(__AVX512VBMI2__)
+  #include <immintrin.h>
+#endif
 
 #include "glog/logging.h"
 
@@ -43,6 +49,52 @@ typedef uint64_t  block_t;
 static const size_t BSIZE = 64;
 static const size_t PRESUM_SZ = 128;
 static const size_t CACHELINE_SZ = 64;
+static const size_t SELECT_SAMPLE_SZ = 128;
+static const size_t NEXT_SCAN_SZ = 4;
+
+/*
+ * A serialized SuccinctBitVector consists of sHeader, a table of
+ * nsec sSections and the section data, each of which starts at
+ * a multiple of CACHELINE_SZ. Integers are in the native byte
+ * order. The select sections are optional because they can be
+ * rebuilt from the rank section.
+ */
+static const uint64_t SBV_MAGIC = 0x3176627463637573ULL;
+static const uint64_t SBV_VERSION = 2;
+
+enum {
+  SEC_BITS = 0,
+  SEC_RANK,
+  SEC_SELECT0,
+  SEC_SELECT1,
+  SEC_NUM
+};
+
+typedef struct {
+  uint64_t  magic;
+  uint64_t  version;
+  uint64_t  size;
+  uint64_t  none;
+  uint64_t  sample;
+  uint64_t  nruns;
+  uint64_t  nsec;
+} sHeader;
+
+typedef struct {
+  uint64_t  type;
+  uint64_t  off;
+  uint64_t  size;
+} sSection;
+
+/*
+ * Density statistics of a built SuccinctBitVector: the number
+ * of bits, ones, and runs of ones.
+ */
+typedef struct {
+  uint64_t  size;
+  uint64_t  none;
+  uint64_t  nruns;
+} dStats;
 
 #ifdef __USE_SSE_POPCNT__
 static uint64_t popcount64(block_t b) {
@@ -141,7 +193,7 @@ static const uint8_t selectPos_[] = {
 };
 
 static uint64_t selectPos(block_t blk, uint64_t r) {
-  __assert(r <= 32);
+  __assert(r < BSIZE);
 
   uint64_t nblock = 0;
   uint64_t cnt = 0;
@@ -161,6 +213,131 @@ static uint64_t selectPos(block_t blk, uint64_t r) {
       selectPos_[(r << 8) + ((blk >> (nblock * 8)) & 0xff)];
 }
 
+/*
+ * Write base plus the positions of ones in blk to out, and return
+ * the number of them. The SIMD versions may write up to
+ * EXTRACT_SLACK_SZ entries past the returned number.
+ */
+#if defined(__AVX512F__) && defined(__AVX512VBMI2__)
+static const size_t EXTRACT_SLACK_SZ = 0;
+
+static inline uint64_t extractPos(block_t blk, uint64_t base,
+                                  uint64_t *out) {
+  static const uint8_t idx[64] __attribute__((aligned(64))) = {
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+    32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63
+  };
+
+  uint8_t buf[64] __attribute__((aligned(64)));
+  _mm512_store_si512(buf, _mm512_maskz_compress_epi8(
+      blk, _mm512_load_si512(idx)));
+
+  uint64_t n = popcount64(blk);
+  __m512i vbase = _mm512_set1_epi64(base);
+
+  for (uint64_t i = 0; i < n; i += 8) {
+    __m512i v = _mm512_cvtepu8_epi64(_mm_loadl_epi64(
+        reinterpret_cast<const __m128i *>(buf + i)));
+    __mmask8 m = (n - i >= 8)? 0xff : (1 << (n - i)) - 1;
+    _mm512_mask_storeu_epi64(out + i, m, _mm512_add_epi64(v, vbase));
+  }
+
+  return n;
+}
+#elif defined(__AVX2__)
+static const size_t EXTRACT_SLACK_SZ = 8;
+
+/* Positions of ones in each byte, padded to 8 entries */
+static const uint8_t *extractPosTable() {
+  static struct Table {
+    uint8_t pos[256][8];
+    Table() {
+      for (int b = 0; b < 256; b++) {
+        int n = 0;
+        for (int i = 0; i < 8; i++) {
+          if (b & (1 << i))
+            pos[b][n++] = i;
+        }
+        while (n < 8)
+          pos[b][n++] = 0;
+      }
+    }
+  } table;
+
+  return &table.pos[0][0];
+}
+
+static inline uint64_t extractPos(block_t blk, uint64_t base,
+                                  uint64_t *out) {
+  const uint8_t *table = extractPosTable();
+  uint64_t n = 0;
+
+  for (uint64_t i = 0; i < 8 && (blk >> (i * 8)); i++) {
+    uint64_t b = (blk >> (i * 8)) & 0xff;
+    __m256i vbase = _mm256_set1_epi64x(base + i * 8);
+
+    __m128i p = _mm_loadl_epi64(
+        reinterpret_cast<const __m128i *>(table + b * 8));
+    __m256i lo = _mm256_add_epi64(_mm256_cvtepu8_epi64(p), vbase);
+    __m256i hi = _mm256_add_epi64(
+        _mm256_cvtepu8_epi64(_mm_srli_si128(p, 4)), vbase);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + n), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + n + 4), hi);
+    n += popcount64(b);
+  }
+
+  return n;
+}
+#else
+static const size_t EXTRACT_SLACK_SZ = 0;
+
+static inline uint64_t extractPos(block_t blk, uint64_t base,
+                                  uint64_t *out) {
+  uint64_t n = 0;
+  while (blk) {
+    out[n++] = base + __builtin_ctzll(blk);
+    blk &= blk - 1;
+  }
+
+  return n;
+}
+#endif /* __AVX512VBMI2__ */
+
+/* Read w (<= BSIZE) bits at pos of a packed array */
+static inline block_t get_bits(const block_t *v, uint64_t pos, size_t w) {
+  if (w == 0)
+    return 0;
+
+  uint64_t i = pos / BSIZE;
+  size_t d = pos % BSIZE;
+
+  block_t blk = v[i] >> d;
+  if (d + w > BSIZE)
+    blk |= v[i + 1] << (BSIZE - d);
+
+  return (w < BSIZE)? blk & ((uint64_t(1) << w) - 1) : blk;
+}
+
+/* Write w bits of val at pos of a zero-filled packed array */
+static inline void put_bits(block_t *v, uint64_t pos, size_t w,
+                            block_t val) {
+  if (w == 0)
+    return;
+
+  if (w < BSIZE)
+    val &= (uint64_t(1) << w) - 1;
+
+  uint64_t i = pos / BSIZE;
+  size_t d = pos % BSIZE;
+
+  v[i] |= val << d;
+  if (d + w > BSIZE)
+    v[i + 1] |= val >> (BSIZE - d);
+}
+
 /*
  * FIXME: rBlock has 32-byte eachs so that its factor
  * is easily aligned to cache-lines. The container needs
@@ -173,6 +350,93 @@ typedef struct {
   uint64_t  b0sum;
 } rBlock;
 
+/*
+ * Kernels over a single rBlock. They are shared by all the
+ * containers that lay out bits in a sequence of rBlocks.
+ */
+
+/* Count ones in the rBlock before (pos % PRESUM_SZ) plus rk */
+static inline uint64_t rblock_rank1(const rBlock& rblk, uint64_t pos) {
+  uint64_t ret = rblk.rk;
+  uint64_t b0 = rblk.b0;
+  uint64_t b1 = rblk.b1;
+
+  size_t r = pos % 64;
+  uint64_t mask = (uint64_t(1) << r) - 1;
+
+  /*
+   * FIXME: gcc seems to generates a conditional jump, so
+   * the code below needs to be replaced with __asm__().
+   */
+  uint64_t m = (pos & 64)? uint64_t(-1) : 0;
+  uint64_t m0 = mask | m;
+  uint64_t m1 = mask & m;
+
+  ret += popcount64(b0 & m0);
+  ret += popcount64(b1 & m1);
+
+  return ret;
+}
+
+/* Return the offset of the rem-th bit in the rBlock */
+static inline uint64_t rblock_select(const rBlock& rblk,
+                                     uint64_t rem, uint8_t bit) {
+  uint64_t b0sum = (bit)? rblk.b0sum : BSIZE - rblk.b0sum;
+
+  if (b0sum > rem)
+    return selectPos((bit)? rblk.b0 : ~rblk.b0, rem);
+
+  return BSIZE + selectPos((bit)? rblk.b1 : ~rblk.b1, rem - b0sum);
+}
+
+/* The number of bits before the idx-th rBlock */
+static inline uint64_t rblock_cumltv(const rBlock& rblk,
+                                     uint64_t idx, uint8_t bit) {
+  return (bit)? rblk.rk : idx * PRESUM_SZ - rblk.rk;
+}
+
+/*
+ * Fill rk and b0sum in a sequence of rBlocks starting with r
+ * ones, and return the number of ones after them.
+ */
+static inline uint64_t rblock_build(rBlock *rblk, size_t num,
+                                    uint64_t r = 0) {
+  for (size_t i = 0; i < num; i++) {
+    rblk[i].rk = r;
+
+    /* b0sum used for select() */
+    uint64_t b0sum = popcount64(rblk[i].b0);
+    rblk[i].b0sum = b0sum;
+
+    r += b0sum;
+    r += popcount64(rblk[i].b1);
+  }
+
+  return r;
+}
+
+/*
+ * Find the last rBlock in [lo, hi] whose cumulative count
+ * is not more than pos. A short range is scanned linearly
+ * because neighbouring rBlocks share cache-lines.
+ */
+static inline uint64_t rblock_search(const rBlock *rblk, uint64_t lo,
+                                     uint64_t hi, uint64_t pos,
+                                     uint8_t bit) {
+  while (hi - lo > CACHELINE_SZ / sizeof(rBlock)) {
+    uint64_t mid = lo + (hi - lo + 1) / 2;
+    if (rblock_cumltv(rblk[mid], mid, bit) <= pos)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  while (lo < hi && rblock_cumltv(rblk[lo + 1], lo + 1, bit) <= pos)
+    lo++;
+
+  return lo;
+}
+
 class BitVector {
  public:
   BitVector() : size_(0), none_(0) {}
@@ -191,8 +455,17 @@ class BitVector {
 
   void set_bit(uint64_t pos, uint8_t bit) {
     __assert(pos < size_);
-    B_[pos / BSIZE] |= uint64_t(1) << (pos % BSIZE);
-    none_++;
+
+    block_t mask = uint64_t(1) << (pos % BSIZE);
+    block_t& blk = B_[pos / BSIZE];
+
+    if (bit && !(blk & mask)) {
+      blk |= mask;
+      none_++;
+    } else if (!bit && (blk & mask)) {
+      blk &= ~mask;
+      none_--;
+    }
   }
 
   bool lookup(uint64_t pos) const {
@@ -201,7 +474,7 @@ class BitVector {
   }
 
   const block_t get_block(uint64_t pos) const {
-    __assert(pos < size_);
+    __assert(pos < B_.size());
     return B_[pos];
   }
 
@@ -217,23 +490,56 @@ class BitVector {
     return none_;
   }
 
+  /* Append the bits of bv, shifting them if not aligned */
+  void append(const BitVector& bv) {
+    uint64_t base = size_ / BSIZE;
+    uint64_t d = size_ % BSIZE;
+
+    size_ += bv.size_;
+    none_ += bv.none_;
+    B_.resize((size_ + BSIZE - 1) / BSIZE, 0);
+
+    for (size_t i = 0; i < bv.B_.size(); i++) {
+      if (d == 0) {
+        B_[base + i] = bv.B_[i];
+        continue;
+      }
+
+      B_[base + i] |= bv.B_[i] << d;
+      if (base + i + 1 < B_.size())
+        B_[base + i + 1] = bv.B_[i] >> (BSIZE - d);
+    }
+  }
+
  private:
-  uint64_t  size_; 
-  uint64_t  none_; 
+  uint64_t  size_;
+  uint64_t  none_;
   std::vector<block_t>  B_;
+
+  friend class SuccinctBitVector;
+  friend class MutableSuccinctBitVector;
 }; /* BitVector */
 
 class SuccinctRank;
 class SuccinctSelect;
+class SuccinctBitVector;
+class SuccinctBitVectorLoader;
+class RankCursor;
+class SelectCursor;
+class SuccinctBitVectorSlice;
+class InterleavedExecutor;
+class MutableSuccinctBitVector;
+class DynamicSuccinctBitVector;
 
 typedef std::shared_ptr<SuccinctRank>   RankPtr;
 typedef std::shared_ptr<SuccinctSelect> SelectPtr;
+typedef std::shared_ptr<SuccinctBitVector> PatternPtr;
 
 class SuccinctRank {
  public:
-  SuccinctRank() : size_(0) {};
+  SuccinctRank() : size_(0), none_(0), nruns_(0) {};
   explicit SuccinctRank(const BitVector& bv) :
-      size_(bv.length()) {init(bv);};
+      size_(bv.length()), none_(0), nruns_(0) {init(bv);};
   ~SuccinctRank() throw() {};
 
   uint64_t rank(uint64_t pos, uint8_t bit) const {
@@ -255,145 +561,167 @@ class SuccinctRank {
     return  rblk_[idx];
   }
 
+  const rBlock *rblocks() const {
+    return rblk_.data();
+  }
+
+  uint64_t rblock_num() const {
+    return rblk_.size();
+  }
+
+  /* The number of ones in [l, r) */
+  uint64_t count1(uint64_t l, uint64_t r) const {
+    __assert(l <= r && r <= size_);
+
+    /* A single rBlock is loaded if both ends fall in it */
+    if (l / PRESUM_SZ == r / PRESUM_SZ) {
+      const rBlock& rblk = rblk_[l / PRESUM_SZ];
+      return rblock_rank1(rblk, r) - rblock_rank1(rblk, l);
+    }
+
+    return rank1(r) - rank1(l);
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
  private:
   /*--- Private functions below ---*/
   void init(const BitVector& bv) {
     size_t bnum = bv.length() / PRESUM_SZ + 1;
     rblk_.resize(bnum);
 
-    uint64_t r = 0;
+    /* The starts of runs of ones are counted in the same pass */
+    block_t prev = 0;
     size_t pos = 0;
     for (size_t i = 0; i < bnum; i++, pos += 2) {
-      uint64_t b0 = (pos < bv.bsize())? bv.get_block(pos) : 0;
-      uint64_t b1 = (pos + 1 < bv.bsize())? bv.get_block(pos + 1) : 0;
+      block_t b0 = (pos < bv.bsize())? bv.get_block(pos) : 0;
+      block_t b1 = (pos + 1 < bv.bsize())? bv.get_block(pos + 1) : 0;
       rblk_[i].b0 = b0;
       rblk_[i].b1 = b1;
-      rblk_[i].rk = r;
-
-      /* b0sum used for select() */
-      uint64_t b0sum = popcount64(b0);
-      rblk_[i].b0sum = b0sum;
 
-      r += b0sum;
-      r += popcount64(b1);
+      nruns_ += popcount64(b0 & ~((b0 << 1) | prev));
+      nruns_ += popcount64(b1 & ~((b1 << 1) | (b0 >> (BSIZE - 1))));
+      prev = b1 >> (BSIZE - 1);
     }
+
+    none_ = rblock_build(rblk_.data(), bnum);
   }
 
   uint64_t rank1(uint64_t pos) const {
     __assert(pos <= size_);
-
-    const rBlock& rblk = rblk_[pos / PRESUM_SZ];
-
-    uint64_t ret = rblk.rk;
-    uint64_t b0 = rblk.b0;
-    uint64_t b1 = rblk.b1;
-
-    size_t r = pos % 64;
-    uint64_t mask = (uint64_t(1) << r) - 1;
-
-    /*
-     * FIXME: gcc seems to generates a conditional jump, so
-     * the code below needs to be replaced with __asm__().
-     */
-    uint64_t m = (pos & 64)? uint64_t(-1) : 0;
-    uint64_t m0 = mask | m;
-    uint64_t m1 = mask & m;
-
-    ret += popcount64(b0 & m0);
-    ret += popcount64(b1 & m1);
-
-    return ret;
+    return rblock_rank1(rblk_[pos / PRESUM_SZ], pos);
   }
 
   uint64_t  size_;
+  uint64_t  none_;
+
+  /* The number of runs of ones, counted by init() */
+  uint64_t  nruns_;
+
   std::vector<rBlock> rblk_;
+
+  friend class SuccinctBitVector;
 }; /* SuccinctRank */
 
+/*
+ * A select dictionary sampling the rBlock that holds every
+ * sample-th bit (SELECT_SAMPLE_SZ by default). A query starts
+ * from the sampled rBlock and searches rk of the rank dictionary
+ * until the next sample, so no extra bit-vector is kept for
+ * select.
+ */
 class SuccinctSelect {
  public:
-  SuccinctSelect() : bit_(1), size_(0) {};
-  explicit SuccinctSelect(const BitVector& bv,
-                          RankPtr& rk, uint8_t bit) :
-      bit_(bit), size_(0), rk_(rk) {init(bv);};
+  SuccinctSelect() : bit_(1), size_(0), sample_(SELECT_SAMPLE_SZ) {};
+  explicit SuccinctSelect(RankPtr& rk, uint8_t bit,
+                          size_t sample = SELECT_SAMPLE_SZ) :
+      bit_(bit), size_(0), sample_(sample), rk_(rk) {init();};
   ~SuccinctSelect() throw() {};
 
   uint64_t select(uint64_t pos) const {
     __assert(pos < size_);
 
-    uint64_t rpos = rkQ_->rank(pos, 1) - 1;
-    rBlock& rblk = rk_->get_rblock(rpos);
+    uint64_t hidx = pos / sample_;
+    uint64_t rpos = rblock_search(rk_->rblocks(), hints_[hidx],
+                                  hints_[hidx + 1], pos, bit_);
+    const rBlock& rblk = rk_->get_rblock(rpos);
 
-    uint64_t rem = pos - cumltv(rblk.rk, rpos * PRESUM_SZ);
-
-    uint64_t rb = 0;
-    block_t blk = 0;
+    uint64_t rem = pos - rblock_cumltv(rblk, rpos, bit_);
+    return rpos * PRESUM_SZ + rblock_select(rblk, rem, bit_);
+  }
 
-    if (cumltv(rblk.b0sum, BSIZE) > rem) {
-      blk = block(rblk.b0);
-      rb = 0;
-    } else {
-      blk = block(rblk.b1);
-      rb = BSIZE;
-      rem -= cumltv(rblk.b0sum, BSIZE);
-    }
+  uint64_t size() const {
+    return size_;
+  }
 
-    return rpos * PRESUM_SZ + rb + selectPos(blk, rem);
+  size_t sample() const {
+    return sample_;
   }
 
  private:
   /*--- Private functions below ---*/
-  void init(const BitVector& bv) {
-    block_t   blk;
-    BitVector Q;
-
-    uint64_t sz = bv.length();
-    size_t bsize = (sz + BSIZE - 1) / BSIZE;
-
-    /* Calculate sz in advance */
-    for (size_t i = 0; i < bsize; i++) {
-      blk = block(bv.get_block(i));
+  void init() {
+    size_ = (bit_)? rk_->get_none() :
+        rk_->length() - rk_->get_none();
 
-      if ((i + 1) * BSIZE > sz) {
-        uint64_t rem = sz - i * BSIZE;
-        blk &= ((uint64_t(1) << rem) - 1);
-      }
+    build_hints(0);
+  }
 
-      size_ += popcount64(blk);
-    }
+  /* Sample rBlocks again, keeping the first nhints samples */
+  void build_hints(uint64_t nhints) {
+    uint64_t bnum = rk_->rblock_num();
+    const rBlock *rblk = rk_->rblocks();
 
-    Q.init(size_);
+    hints_.resize(nhints);
+    hints_.reserve(size_ / sample_ + 2);
 
-    uint64_t qcount = 0;
-    for (size_t i = 0; i < bsize; i++) {
-      if (i % (PRESUM_SZ / BSIZE) == 0)
-        Q.set_bit(qcount, 1);
+    uint64_t i = (nhints)? hints_.back() : 0;
+    for (uint64_t pos = nhints * sample_;
+         pos < size_; pos += sample_) {
+      while (i + 1 < bnum &&
+             rblock_cumltv(rblk[i + 1], i + 1, bit_) <= pos)
+        i++;
 
-      blk = block(bv.get_block(i));
-      qcount += popcount64(blk);
+      hints_.push_back(i);
     }
 
-    RankPtr rkQ(new SuccinctRank(Q));
-    rkQ_ = rkQ;
+    /* A sentinel to bound the last search */
+    hints_.push_back(bnum - 1);
   }
 
-  inline uint64_t cumltv(uint64_t val,
-                         uint64_t pos) const {
-    return (bit_)? val : pos - val;
-  }
+  /* Loaded hints must be increasing indices of rBlocks */
+  bool valid_hints() const {
+    for (size_t i = 0; i < hints_.size(); i++) {
+      if (hints_[i] >= rk_->rblock_num() ||
+          (i != 0 && hints_[i] < hints_[i - 1]))
+        return false;
+    }
 
-  inline block_t block(block_t b) const {
-    return (bit_)? b : ~b;
+    return true;
   }
 
   uint8_t   bit_;
   uint64_t  size_;
-  RankPtr   rkQ_;
+  size_t    sample_;
+
+  /* Indices of rBlocks sampled by sample_ */
+  std::vector<uint64_t> hints_;
 
   /*
   * A reference to the rank dictionary
   * of the orignal bit-vector.
   */
   RankPtr   rk_;
+
+  friend class SuccinctBitVector;
+  friend class SelectCursor;
+  friend class InterleavedExecutor;
 }; /* SuccinctSelect */
 
 /* } namespace: */
@@ -401,21 +729,32 @@ class SuccinctSelect {
 class SuccinctBitVector {
  public:
   SuccinctBitVector() : rk_((SuccinctRank *)0),
-    st0_((SuccinctSelect *)0), st1_((SuccinctSelect *)0) {};
+    st0_((SuccinctSelect *)0), st1_((SuccinctSelect *)0), stats_() {};
   ~SuccinctBitVector() throw() {};
 
   /* Functions to initialize */
   void init(uint64_t size) {bv_.init(size);}
 
-  void build() {
+  /*
+   * Build the dictionaries. A smaller sample makes select faster
+   * and its dictionaries larger; see SuccinctBitVectorTuner.
+   */
+  void build(size_t sample = SELECT_SAMPLE_SZ) {
     if (bv_.length() == 0)
       throw "Not initialized yet: bv_";
+    if (sample == 0)
+      throw "Invalid input: sample";
 
     RankPtr rk(new SuccinctRank(bv_));
-    SelectPtr st0(new SuccinctSelect(bv_, rk, 0));
-    SelectPtr st1(new SuccinctSelect(bv_, rk, 1));
+    SelectPtr st0(new SuccinctSelect(rk, 0, sample));
+    SelectPtr st1(new SuccinctSelect(rk, 1, sample));
 
     rk_ = rk, st0_ = st0, st1_ = st1;
+    reset_patterns();
+
+    stats_.size = bv_.length();
+    stats_.none = bv_.get_none();
+    stats_.nruns = rk->nruns_;
   }
 
   void set_bit(uint64_t pos, uint8_t bit) {
@@ -445,15 +784,721 @@ class SuccinctBitVector {
   }
 
   uint64_t select(uint64_t pos, uint8_t bit) const {
-    if (pos >= bv_.get_none())
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    const SelectPtr& st = (bit)? st1_ : st0_;
+    if (pos >= st->size())
+      throw "Invalid input: pos";
+
+    return st->select(pos);
+  }
+
+  /*
+   * Select with a position near the result. rBlocks are scanned
+   * forward or backward from hint in up to NEXT_SCAN_SZ rBlocks,
+   * and select() is used if the result is not found in them.
+   */
+  uint64_t select_from(uint64_t hint, uint64_t pos, uint8_t bit) const {
+    if (hint >= bv_.length())
+      throw "Invalid input: hint";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    const SelectPtr& st = (bit)? st1_ : st0_;
+    if (pos >= st->size())
+      throw "Invalid input: pos";
+
+    const rBlock *rblk = rk_->rblocks();
+    uint64_t bnum = rk_->rblock_num();
+    uint64_t i = hint / PRESUM_SZ;
+
+    if (rblock_cumltv(rblk[i], i, bit) <= pos) {
+      uint64_t end = std::min(i + NEXT_SCAN_SZ, bnum - 1);
+      while (i < end && rblock_cumltv(rblk[i + 1], i + 1, bit) <= pos)
+        i++;
+
+      if (i + 1 < bnum && rblock_cumltv(rblk[i + 1], i + 1, bit) <= pos)
+        return st->select(pos);
+    } else {
+      uint64_t end = (i > NEXT_SCAN_SZ)? i - NEXT_SCAN_SZ : 0;
+      while (i > end && rblock_cumltv(rblk[i], i, bit) > pos)
+        i--;
+
+      if (rblock_cumltv(rblk[i], i, bit) > pos)
+        return st->select(pos);
+    }
+
+    uint64_t rem = pos - rblock_cumltv(rblk[i], i, bit);
+    return i * PRESUM_SZ + rblock_select(rblk[i], rem, bit);
+  }
+
+  /*
+   * Successor & predecessor operations. They scan words from pos
+   * in up to NEXT_SCAN_SZ rBlocks, and fall back to select() over
+   * longer gaps. length() is returned if no such bit exists.
+   */
+  uint64_t next(uint64_t pos, uint8_t bit) const {
+    if (pos > bv_.length())
       throw "Invalid input: pos";
     if (bit > 1)
       throw "Invalid input: bit";
 
-    return (bit)? st1_->select(pos) : st0_->select(pos);
+    uint64_t len = bv_.length();
+    if (pos == len)
+      return len;
+
+    const rBlock *rblk = rk_->rblocks();
+    uint64_t bnum = rk_->rblock_num();
+
+    uint64_t i = pos / PRESUM_SZ;
+    uint64_t end = std::min(i + NEXT_SCAN_SZ, bnum);
+    uint64_t w = (pos / BSIZE) % 2;
+    block_t mask = uint64_t(-1) << (pos % BSIZE);
+
+    for (; i < end; i++, w = 0) {
+      for (; w < 2; w++, mask = uint64_t(-1)) {
+        block_t blk = (w)? rblk[i].b1 : rblk[i].b0;
+        blk = ((bit)? blk : ~blk) & mask;
+
+        if (blk) {
+          uint64_t p = i * PRESUM_SZ + w * BSIZE + __builtin_ctzll(blk);
+          return std::min(p, len);
+        }
+      }
+    }
+
+    if (i >= bnum)
+      return len;
+
+    const SelectPtr& st = (bit)? st1_ : st0_;
+    uint64_t r = rblock_cumltv(rblk[i], i, bit);
+    return (r < st->size())? st->select(r) : len;
+  }
+
+  uint64_t prev(uint64_t pos, uint8_t bit) const {
+    if (pos >= bv_.length())
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    const rBlock *rblk = rk_->rblocks();
+
+    uint64_t i = pos / PRESUM_SZ;
+    uint64_t end = (i + 1 > NEXT_SCAN_SZ)? i + 1 - NEXT_SCAN_SZ : 0;
+    uint64_t w = (pos / BSIZE) % 2;
+    block_t mask = uint64_t(-1) >> (BSIZE - 1 - pos % BSIZE);
+
+    for (;; i--, w = 1, mask = uint64_t(-1)) {
+      for (;; w--, mask = uint64_t(-1)) {
+        block_t blk = (w)? rblk[i].b1 : rblk[i].b0;
+        blk = ((bit)? blk : ~blk) & mask;
+
+        if (blk)
+          return i * PRESUM_SZ + w * BSIZE + BSIZE - 1 -
+              __builtin_clzll(blk);
+        if (w == 0)
+          break;
+      }
+
+      if (i == end)
+        break;
+    }
+
+    const SelectPtr& st = (bit)? st1_ : st0_;
+    uint64_t r = rblock_cumltv(rblk[i], i, bit);
+    return (r > 0)? st->select(r - 1) : bv_.length();
+  }
+
+  /* Range operations over [l, r) */
+  uint64_t count(uint64_t l, uint64_t r, uint8_t bit) const {
+    if (l > r || r > bv_.length())
+      throw "Invalid input: range";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t c = rk_->count1(l, r);
+    return (bit)? c : (r - l) - c;
+  }
+
+  /* The pos-th bit in [l, r), or r if no such bit exists */
+  uint64_t select_in_range(uint64_t l, uint64_t r,
+                           uint64_t pos, uint8_t bit) const {
+    if (l > r || r > bv_.length())
+      throw "Invalid input: range";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    if (l == r)
+      return r;
+
+    uint64_t i = l / PRESUM_SZ;
+    const rBlock& rblk = rk_->get_rblock(i);
+
+    /* The number of bits before l in the rBlock and in total */
+    uint64_t before = rblock_rank1(rblk, l) - rblk.rk;
+    if (!bit)
+      before = l % PRESUM_SZ - before;
+
+    uint64_t rem = before + pos;
+    uint64_t ones = popcount64(rblk.b0) + popcount64(rblk.b1);
+    uint64_t nbits = (bit)? ones : PRESUM_SZ - ones;
+
+    uint64_t p = r;
+    if (rem < nbits) {
+      p = i * PRESUM_SZ + rblock_select(rblk, rem, bit);
+    } else {
+      const SelectPtr& st = (bit)? st1_ : st0_;
+      rem += rblock_cumltv(rblk, i, bit);
+      if (rem < st->size())
+        p = st->select(rem);
+    }
+
+    return std::min(p, r);
+  }
+
+  /*
+   * Write the positions of bits in [l, r) to out, which must
+   * have room for count(l, r, bit) entries, and return the
+   * number of them.
+   */
+  uint64_t extract(uint64_t l, uint64_t r, uint8_t bit,
+                   uint64_t *out) const {
+    uint64_t n = count(l, r, bit);
+    if (n == 0)
+      return 0;
+
+    uint64_t i = l / BSIZE;
+    uint64_t end = (r - 1) / BSIZE;
+    uint64_t ret = 0;
+
+    for (; i <= end; i++) {
+      block_t blk = bv_.get_block(i);
+      blk = (bit)? blk : ~blk;
+
+      if (i == l / BSIZE)
+        blk &= uint64_t(-1) << (l % BSIZE);
+      if (i == end && r % BSIZE != 0)
+        blk &= (uint64_t(1) << (r % BSIZE)) - 1;
+
+      /* Avoid writing past out in the last words */
+      if (ret + popcount64(blk) + EXTRACT_SLACK_SZ > n) {
+        while (blk) {
+          out[ret++] = i * BSIZE + __builtin_ctzll(blk);
+          blk &= blk - 1;
+        }
+      } else {
+        ret += extractPos(blk, i * BSIZE, out + ret);
+      }
+    }
+
+    __assert(ret == n);
+    return ret;
+  }
+
+  std::vector<uint64_t> extract_positions(uint64_t l, uint64_t r,
+                                          uint8_t bit) const {
+    std::vector<uint64_t> out(count(l, r, bit));
+    if (!out.empty())
+      extract(l, r, bit, out.data());
+    return out;
+  }
+
+  bool any(uint64_t l, uint64_t r, uint8_t bit) const {
+    return count(l, r, bit) != 0;
+  }
+
+  bool none(uint64_t l, uint64_t r, uint8_t bit) const {
+    return count(l, r, bit) == 0;
+  }
+
+  /* A view of [l, r) sharing the dictionaries with this vector */
+  SuccinctBitVectorSlice slice(uint64_t l, uint64_t r) const;
+
+  /*
+   * Rank & Select operations over 2-bit patterns, e.g. "10".
+   * An occurrence at i means the pattern is found in bits i
+   * and i + 1. The directory of a pattern is a vector marking
+   * the occurrences, which is built by build_pattern() and
+   * dropped by build(), append() and load().
+   */
+  void build_pattern(const char *pattern) {
+    if (!rk_)
+      throw "Not built yet: rk_";
+
+    uint64_t p = pattern_index(pattern);
+    uint64_t len = bv_.length();
+
+    PatternPtr pt(new SuccinctBitVector());
+    pt->init(len);
+
+    for (uint64_t i = 0; i < bv_.bsize(); i++) {
+      block_t w = bv_.get_block(i);
+      block_t next = (i + 1 < bv_.bsize())? bv_.get_block(i + 1) : 0;
+      block_t w1 = (w >> 1) | (next << (BSIZE - 1));
+
+      block_t blk = ((p & 2)? w : ~w) & ((p & 1)? w1 : ~w1);
+
+      /* No occurrence starts at the last bit */
+      if (i == (len - 1) / BSIZE)
+        blk &= (uint64_t(1) << ((len - 1) % BSIZE)) - 1;
+
+      pt->bv_.B_[i] = blk;
+      pt->bv_.none_ += popcount64(blk);
+    }
+
+    pt->build();
+    pt_[p] = pt;
+  }
+
+  /* The number of occurrences in [0, pos] */
+  uint64_t rank_pattern(uint64_t pos, const char *pattern) const {
+    if (pos >= bv_.length())
+      throw "Invalid input: pos";
+
+    const PatternPtr& pt = pattern_dict(pattern);
+    return (pos > 0)? pt->rank(pos - 1, 1) : 0;
+  }
+
+  /* The start of the pos-th occurrence */
+  uint64_t select_pattern(uint64_t pos, const char *pattern) const {
+    const PatternPtr& pt = pattern_dict(pattern);
+    if (pos >= pt->get_none())
+      throw "Invalid input: pos";
+
+    return pt->select(pos, 1);
+  }
+
+  uint64_t count_pattern(const char *pattern) const {
+    return pattern_dict(pattern)->get_none();
+  }
+
+  uint64_t length() const {
+    return bv_.length();
+  }
+
+  uint64_t get_none() const {
+    return bv_.get_none();
+  }
+
+  /* Statistics gathered by build(), append() and load() */
+  const dStats& stats() const {
+    return stats_;
+  }
+
+  /* The sampling rate of the select dictionaries */
+  size_t select_sample() const {
+    if (!st1_)
+      throw "Not built yet: st1_";
+
+    return st1_->sample();
+  }
+
+  /*
+   * Append a built vector to this built one. The rBlocks of sbv
+   * are reused with rk shifted if length() is a multiple of
+   * PRESUM_SZ; otherwise the appended bits are shifted into new
+   * rBlocks. Select dictionaries are only sampled for the new
+   * bits in either case.
+   */
+  void append(const SuccinctBitVector& sbv) {
+    if (!rk_ || !sbv.rk_)
+      throw "Not built yet: rk_";
+
+    if (&sbv == this) {
+      SuccinctBitVector tmp(sbv);
+      append(tmp);
+      return;
+    }
+
+    detach();
+    reset_patterns();
+
+    uint64_t len = bv_.length();
+    uint64_t ones = bv_.get_none();
+    uint64_t nsel[2] = {st0_->size_, st1_->size_};
+
+    /* Runs at the junction are merged */
+    stats_.nruns += sbv.stats_.nruns -
+        (bv_.lookup(len - 1) && sbv.bv_.lookup(0));
+
+    bv_.append(sbv.bv_);
+
+    std::vector<rBlock>& rblk = rk_->rblk_;
+    const std::vector<rBlock>& orblk = sbv.rk_->rblk_;
+
+    if (len % PRESUM_SZ == 0) {
+      /* Replace the sentinel with the first rBlock of sbv */
+      rblk.pop_back();
+      for (size_t i = 0; i < orblk.size(); i++) {
+        rblk.push_back(orblk[i]);
+        rblk.back().rk += ones;
+      }
+    } else {
+      size_t from = len / PRESUM_SZ;
+      rblk.resize(bv_.length() / PRESUM_SZ + 1);
+
+      for (size_t i = from; i < rblk.size(); i++) {
+        rblk[i].b0 = (2 * i < bv_.bsize())? bv_.get_block(2 * i) : 0;
+        rblk[i].b1 = (2 * i + 1 < bv_.bsize())?
+            bv_.get_block(2 * i + 1) : 0;
+      }
+
+      rblock_build(&rblk[from], rblk.size() - from, rblk[from].rk);
+    }
+
+    rk_->size_ = bv_.length();
+    rk_->none_ = bv_.get_none();
+    stats_.size = bv_.length();
+    stats_.none = bv_.get_none();
+
+    SelectPtr st[2] = {st0_, st1_};
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      st[bit]->size_ = (bit)? rk_->none_ : rk_->size_ - rk_->none_;
+      st[bit]->build_hints((nsel[bit] + st[bit]->sample_ - 1) /
+                           st[bit]->sample_);
+    }
+  }
+
+  /* Concatenate built vectors into a new one */
+  static SuccinctBitVector concat(
+      const std::vector<const SuccinctBitVector *>& parts) {
+    if (parts.empty())
+      throw "Invalid input: parts";
+
+    SuccinctBitVector sbv = *parts[0];
+    sbv.detach();
+
+    uint64_t len = 0;
+    for (size_t i = 0; i < parts.size(); i++)
+      len += parts[i]->length();
+
+    sbv.bv_.B_.reserve((len + BSIZE - 1) / BSIZE);
+    sbv.rk_->rblk_.reserve(len / PRESUM_SZ + 1);
+
+    for (size_t i = 1; i < parts.size(); i++)
+      sbv.append(*parts[i]);
+
+    return sbv;
+  }
+
+  /*
+   * Flip the bits at n increasing positions of a built vector.
+   * Only the rBlocks with flipped bits are counted again, and
+   * the counts in the following ones are shifted. Select hints
+   * are sampled again from the first flipped rBlock, and the
+   * number of runs is updated from the neighbours of each flipped
+   * bit. Shifting the counts costs O(n / PRESUM_SZ) time, and the
+   * rank and select dictionaries shared with copies of the vector
+   * are copied first, which costs O(n) time and space.
+   */
+  void flip_bits(const uint64_t *pos, size_t n) {
+    if (!rk_)
+      throw "Not built yet: rk_";
+    for (size_t i = 0; i < n; i++) {
+      if (pos[i] >= bv_.length() || (i != 0 && pos[i] <= pos[i - 1]))
+        throw "Invalid input: pos";
+    }
+
+    if (n == 0)
+      return;
+
+    detach();
+    reset_patterns();
+
+    std::vector<rBlock>& rblk = rk_->rblk_;
+    uint64_t first = pos[0] / PRESUM_SZ;
+
+    int64_t shift = 0;
+    int64_t nruns = 0;
+    for (size_t i = first, j = 0; i < rblk.size(); i++) {
+      rblk[i].rk += shift;
+      if (j == n || pos[j] / PRESUM_SZ != i)
+        continue;
+
+      uint64_t old = rblk[i].b0sum + popcount64(rblk[i].b1);
+      for (; j < n && pos[j] / PRESUM_SZ == i; j++) {
+        uint8_t bit = bv_.lookup(pos[j]);
+        int64_t d = 1 - ((pos[j] != 0)? bv_.lookup(pos[j] - 1) : 0) -
+            ((pos[j] + 1 < bv_.length())? bv_.lookup(pos[j] + 1) : 0);
+        nruns += (bit)? -d : d;
+        bv_.set_bit(pos[j], !bit);
+      }
+
+      rblk[i].b0 = (2 * i < bv_.bsize())? bv_.get_block(2 * i) : 0;
+      rblk[i].b1 = (2 * i + 1 < bv_.bsize())?
+          bv_.get_block(2 * i + 1) : 0;
+      rblk[i].b0sum = popcount64(rblk[i].b0);
+      shift += rblk[i].b0sum + popcount64(rblk[i].b1) - old;
+    }
+
+    rk_->none_ = bv_.get_none();
+
+    /* Hints before the first flipped rBlock are still valid */
+    SelectPtr st[2] = {st0_, st1_};
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      std::vector<uint64_t>& h = st[bit]->hints_;
+      st[bit]->size_ = (bit)? rk_->none_ : rk_->size_ - rk_->none_;
+      st[bit]->build_hints(std::lower_bound(h.begin(), h.end() - 1, first) -
+                           h.begin());
+    }
+
+    stats_.none = rk_->none_;
+    stats_.nruns += nruns;
+  }
+
+  /* Exchange the contents with sbv with no copies */
+  void swap(SuccinctBitVector& sbv) {
+    std::swap(bv_.size_, sbv.bv_.size_);
+    std::swap(bv_.none_, sbv.bv_.none_);
+    bv_.B_.swap(sbv.bv_.B_);
+
+    rk_.swap(sbv.rk_);
+    st0_.swap(sbv.st0_);
+    st1_.swap(sbv.st1_);
+    for (size_t i = 0; i < PATTERN_NUM; i++)
+      pt_[i].swap(sbv.pt_[i]);
+
+    std::swap(stats_, sbv.stats_);
+  }
+
+  /* Functions to serialize */
+  void save(std::ostream& os, bool with_select = true) const {
+    if (!rk_)
+      throw "Not built yet: rk_";
+
+    sHeader hdr = header();
+    std::vector<sSection> sec = sections(with_select);
+    hdr.nsec = sec.size();
+
+    os.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    os.write(reinterpret_cast<const char *>(sec.data()),
+             sec.size() * sizeof(sSection));
+
+    uint64_t off = sizeof(hdr) + sec.size() * sizeof(sSection);
+    for (size_t i = 0; i < sec.size(); i++) {
+      static const char pad[CACHELINE_SZ] = {0};
+      os.write(pad, sec[i].off - off);
+
+      uint64_t sz = 0;
+      const char *data = section_data(sec[i].type, sz);
+      os.write(data, sz);
+      off = sec[i].off + sz;
+    }
+
+    if (!os)
+      throw "Failed to write: os";
+  }
+
+  void load(std::istream& is) {
+    sHeader hdr;
+    is.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    if (!is || hdr.magic != SBV_MAGIC || hdr.version != SBV_VERSION ||
+        hdr.nsec > SEC_NUM)
+      throw "Corrupted data: header";
+
+    std::vector<sSection> sec(hdr.nsec);
+    is.read(reinterpret_cast<char *>(sec.data()),
+            sec.size() * sizeof(sSection));
+    check_sections(sec);
+
+    alloc(hdr);
+
+    uint64_t off = sizeof(hdr) + sec.size() * sizeof(sSection);
+    for (size_t i = 0; i < sec.size(); i++) {
+      uint64_t sz = 0;
+      char *data = section_data(sec[i].type, sz);
+
+      if (sec[i].off < off || sec[i].size != sz)
+        throw "Corrupted data: section";
+
+      is.ignore(sec[i].off - off);
+      is.read(data, sz);
+      off = sec[i].off + sz;
+    }
+
+    if (!is)
+      throw "Corrupted data: is";
+
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      if (has_section(sec, SEC_SELECT0 + bit))
+        check_select(bit);
+      else
+        build_select(bit);
+    }
   }
 
  private:
+  /*--- Private functions below ---*/
+  sHeader header() const {
+    sHeader hdr;
+    hdr.magic = SBV_MAGIC;
+    hdr.version = SBV_VERSION;
+    hdr.size = bv_.length();
+    hdr.none = bv_.get_none();
+    hdr.sample = st1_->sample_;
+    hdr.nruns = stats_.nruns;
+    hdr.nsec = 0;
+    return hdr;
+  }
+
+  std::vector<sSection> sections(bool with_select) const {
+    std::vector<sSection> sec;
+    uint64_t nsec = (with_select)? SEC_NUM : SEC_SELECT0;
+    uint64_t off = sizeof(sHeader) + nsec * sizeof(sSection);
+
+    for (uint64_t type = 0; type < nsec; type++) {
+      sSection s;
+      s.type = type;
+      s.off = (off + CACHELINE_SZ - 1) / CACHELINE_SZ * CACHELINE_SZ;
+      section_data(type, s.size);
+
+      sec.push_back(s);
+      off = s.off + s.size;
+    }
+
+    return sec;
+  }
+
+  static bool has_section(const std::vector<sSection>& sec,
+                          uint64_t type) {
+    for (size_t i = 0; i < sec.size(); i++) {
+      if (sec[i].type == type)
+        return true;
+    }
+
+    return false;
+  }
+
+  /* The bits and the rank are required, and no type is repeated */
+  static void check_sections(const std::vector<sSection>& sec) {
+    bool seen[SEC_NUM] = {false};
+    for (size_t i = 0; i < sec.size(); i++) {
+      if (sec[i].type >= SEC_NUM || seen[sec[i].type])
+        throw "Corrupted data: section";
+      seen[sec[i].type] = true;
+    }
+
+    if (!seen[SEC_BITS] || !seen[SEC_RANK])
+      throw "Corrupted data: section";
+  }
+
+  /* Check the hints of a loaded select against the rank */
+  void check_select(uint8_t bit) const {
+    const SelectPtr& st = (bit)? st1_ : st0_;
+    if (!st->valid_hints())
+      throw "Corrupted data: section";
+  }
+
+  /* Allocate all the sections with a given header */
+  void alloc(const sHeader& hdr) {
+    if (hdr.size == 0 || hdr.none > hdr.size || hdr.sample == 0 ||
+        hdr.nruns > hdr.none)
+      throw "Corrupted data: header";
+
+    bv_.init(hdr.size);
+    bv_.none_ = hdr.none;
+
+    RankPtr rk(new SuccinctRank());
+    rk->size_ = hdr.size;
+    rk->none_ = hdr.none;
+    rk->rblk_.resize(hdr.size / PRESUM_SZ + 1);
+
+    SelectPtr st[2];
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      st[bit] = SelectPtr(new SuccinctSelect());
+      st[bit]->bit_ = bit;
+      st[bit]->size_ = (bit)? hdr.none : hdr.size - hdr.none;
+      st[bit]->sample_ = hdr.sample;
+      st[bit]->rk_ = rk;
+      st[bit]->hints_.resize((st[bit]->size_ + hdr.sample - 1) /
+                             hdr.sample + 1);
+    }
+
+    rk_ = rk, st0_ = st[0], st1_ = st[1];
+    reset_patterns();
+
+    stats_.size = hdr.size;
+    stats_.none = hdr.none;
+    stats_.nruns = hdr.nruns;
+  }
+
+  /* Return the storage of a section and its size in bytes */
+  const char *section_data(uint64_t type, uint64_t& size) const {
+    switch (type) {
+      case SEC_BITS:
+        size = bv_.B_.size() * sizeof(block_t);
+        return reinterpret_cast<const char *>(bv_.B_.data());
+      case SEC_RANK:
+        size = rk_->rblk_.size() * sizeof(rBlock);
+        return reinterpret_cast<const char *>(rk_->rblk_.data());
+      case SEC_SELECT0:
+      case SEC_SELECT1: {
+        const SelectPtr& st = (type == SEC_SELECT1)? st1_ : st0_;
+        size = st->hints_.size() * sizeof(uint64_t);
+        return reinterpret_cast<const char *>(st->hints_.data());
+      }
+    }
+
+    throw "Corrupted data: type";
+  }
+
+  char *section_data(uint64_t type, uint64_t& size) {
+    return const_cast<char *>(static_cast<const SuccinctBitVector *>(
+        this)->section_data(type, size));
+  }
+
+  /*
+   * Copies of a vector share the dictionaries, so they are
+   * copied before being updated. Besides rk_ itself, the only
+   * holders of the rank owned by this vector are st0_ and st1_,
+   * when they were built on it. Any other holder, such as a copy
+   * of the vector or a slice, makes the rank shared.
+   */
+  void detach() {
+    long owned = 1 + (st0_ && st0_->rk_ == rk_) +
+        (st1_ && st1_->rk_ == rk_);
+    if (rk_.use_count() > owned)
+      rk_ = RankPtr(new SuccinctRank(*rk_));
+    if (st0_.use_count() > 1)
+      st0_ = SelectPtr(new SuccinctSelect(*st0_));
+    if (st1_.use_count() > 1)
+      st1_ = SelectPtr(new SuccinctSelect(*st1_));
+
+    st0_->rk_ = rk_, st1_->rk_ = rk_;
+  }
+
+  uint64_t pattern_index(const char *pattern) const {
+    if (pattern == NULL || strlen(pattern) != 2 ||
+        (pattern[0] != '0' && pattern[0] != '1') ||
+        (pattern[1] != '0' && pattern[1] != '1'))
+      throw "Invalid input: pattern";
+
+    return (pattern[0] - '0') * 2 + (pattern[1] - '0');
+  }
+
+  const PatternPtr& pattern_dict(const char *pattern) const {
+    const PatternPtr& pt = pt_[pattern_index(pattern)];
+    if (!pt)
+      throw "Not built yet: pattern";
+    return pt;
+  }
+
+  void reset_patterns() {
+    for (size_t i = 0; i < PATTERN_NUM; i++)
+      pt_[i].reset();
+  }
+
+  /* Rebuild a select dictionary from the rank dictionary */
+  void build_select(uint8_t bit) {
+    const SelectPtr& old = (bit)? st1_ : st0_;
+    SelectPtr st(new SuccinctSelect(rk_, bit, old->sample_));
+    if (bit)
+      st1_ = st;
+    else
+      st0_ = st;
+  }
+
   /* A sequence of bit-array */
   BitVector bv_;
 
@@ -461,8 +1506,216 @@ class SuccinctBitVector {
   RankPtr   rk_;
   SelectPtr st0_;
   SelectPtr st1_;
+
+  /* Directories of 2-bit patterns indexed by their values */
+  static const size_t PATTERN_NUM = 4;
+  PatternPtr pt_[PATTERN_NUM];
+
+  dStats    stats_;
+
+  friend class SuccinctBitVectorLoader;
+  friend class RankCursor;
+  friend class SelectCursor;
+  friend class SuccinctBitVectorSlice;
+  friend class InterleavedExecutor;
+  friend class MutableSuccinctBitVector;
+  friend class DynamicSuccinctBitVector;
 }; /* SuccinctBitVector */
 
+/*
+ * A view of bits [l, r) in a built SuccinctBitVector. Positions
+ * are relative to l, and queries are answered by the rank/select
+ * dictionaries of the parent with the counts before l, so no bits
+ * are copied. The view holds the dictionaries, so it stays valid
+ * even if the parent is updated or destroyed.
+ */
+class SuccinctBitVectorSlice {
+ public:
+  SuccinctBitVectorSlice(const SuccinctBitVector& sbv,
+                         uint64_t l, uint64_t r) :
+      off_(l), size_(r - l), rk_(sbv.rk_),
+      st0_(sbv.st0_), st1_(sbv.st1_) {
+    if (!rk_)
+      throw "Not built yet: rk_";
+    if (l > r || r > rk_->length())
+      throw "Invalid input: range";
+
+    base_ = rk_->count1(0, l);
+    none_ = rk_->count1(l, r);
+  }
+  ~SuccinctBitVectorSlice() throw() {}
+
+  bool lookup(uint64_t pos) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+
+    pos += off_;
+
+    const rBlock& rblk = rk_->get_rblock(pos / PRESUM_SZ);
+    block_t blk = (pos & BSIZE)? rblk.b1 : rblk.b0;
+    return (blk & (uint64_t(1) << (pos % BSIZE))) > 0;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    if (pos >= size_)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    uint64_t r = rk_->rank(off_ + pos, 1) - base_;
+    return (bit)? r : pos + 1 - r;
+  }
+
+  uint64_t select(uint64_t pos, uint8_t bit) const {
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= count(bit))
+      throw "Invalid input: pos";
+
+    if (bit)
+      return st1_->select(base_ + pos) - off_;
+
+    return st0_->select(off_ - base_ + pos) - off_;
+  }
+
+  uint64_t length() const {
+    return size_;
+  }
+
+  uint64_t get_none() const {
+    return none_;
+  }
+
+  /* The offset of the view in the parent */
+  uint64_t offset() const {
+    return off_;
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  uint64_t count(uint8_t bit) const {
+    return (bit)? none_ : size_ - none_;
+  }
+
+  uint64_t  off_;
+  uint64_t  size_;
+
+  /* The number of ones before off_ and in the view */
+  uint64_t  base_;
+  uint64_t  none_;
+
+  RankPtr   rk_;
+  SelectPtr st0_;
+  SelectPtr st1_;
+}; /* SuccinctBitVectorSlice */
+
+inline SuccinctBitVectorSlice SuccinctBitVector::slice(
+    uint64_t l, uint64_t r) const {
+  return SuccinctBitVectorSlice(*this, l, r);
+}
+
+/*
+ * A cursor for rank queries in non-decreasing order. It keeps
+ * a copy of the current rBlock, so queries falling in the same
+ * rBlock load nothing, and prefetches the next rBlock when it
+ * moves forward. Queries out of order are still answered.
+ */
+class RankCursor {
+ public:
+  explicit RankCursor(const SuccinctBitVector& sbv) :
+      rk_(sbv.rk_), idx_(0) {
+    if (!rk_)
+      throw "Not built yet: rk_";
+
+    cur_ = rk_->get_rblock(0);
+  }
+  ~RankCursor() throw() {}
+
+  uint64_t rank(uint64_t pos, uint8_t bit) {
+    if (pos >= rk_->length())
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    uint64_t i = pos / PRESUM_SZ;
+    if (i != idx_) {
+      idx_ = i;
+      cur_ = rk_->get_rblock(i);
+
+      if (i + 1 < rk_->rblock_num())
+        __builtin_prefetch(&rk_->get_rblock(i + 1));
+    }
+
+    uint64_t r = rblock_rank1(cur_, pos);
+    return (bit)? r : pos - r;
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  RankPtr   rk_;
+  uint64_t  idx_;
+  rBlock    cur_;
+}; /* RankCursor */
+
+/*
+ * A cursor for select queries in non-decreasing order. It keeps
+ * the current rBlock and scans rk forward in up to NEXT_SCAN_SZ
+ * rBlocks. A longer gap is searched between the current rBlock
+ * and the next sample of the select dictionary, and a query out
+ * of order starts from the samples again.
+ */
+class SelectCursor {
+ public:
+  SelectCursor(const SuccinctBitVector& sbv, uint8_t bit) :
+      bit_(bit), rk_(sbv.rk_), idx_(0) {
+    if (!rk_)
+      throw "Not built yet: rk_";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    st_ = (bit)? sbv.st1_ : sbv.st0_;
+  }
+  ~SelectCursor() throw() {}
+
+  uint64_t select(uint64_t pos) {
+    if (pos >= st_->size())
+      throw "Invalid input: pos";
+
+    const rBlock *rblk = rk_->rblocks();
+    uint64_t bnum = rk_->rblock_num();
+
+    uint64_t i = idx_;
+    if (rblock_cumltv(rblk[i], i, bit_) > pos)
+      i = 0;
+
+    uint64_t end = std::min(i + NEXT_SCAN_SZ, bnum - 1);
+    while (i < end && rblock_cumltv(rblk[i + 1], i + 1, bit_) <= pos)
+      i++;
+
+    if (i == end && i + 1 < bnum &&
+        rblock_cumltv(rblk[i + 1], i + 1, bit_) <= pos) {
+      uint64_t hidx = pos / st_->sample_;
+      i = rblock_search(rblk, std::max(i, st_->hints_[hidx]),
+                        st_->hints_[hidx + 1], pos, bit_);
+    }
+
+    idx_ = i;
+
+    uint64_t rem = pos - rblock_cumltv(rblk[i], i, bit_);
+    return i * PRESUM_SZ + rblock_select(rblk[i], rem, bit_);
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  uint8_t   bit_;
+  RankPtr   rk_;
+  SelectPtr st_;
+  uint64_t  idx_;
+}; /* SelectCursor */
+
 } /* dense */
 } /* succinct */
 
@@ -0,0 +1,143 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorExecutor.hpp - A parallel executor for batched queries
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __SUCCINCTBITVECTOREXECUTOR_HPP__
+#define __SUCCINCTBITVECTOREXECUTOR_HPP__
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+#include "ThreadPool.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * SuccinctBitVectorExecutor answers a batch of independent queries
+ * against a read-only SuccinctBitVector with a pool of threads. A
+ * batch is split into tasks of BATCH_SZ queries, which are handed
+ * out dynamically, so skewed tasks are balanced among the threads.
+ * If bucket is set, the queries in a task are sorted by the rBlock
+ * (or select sample) they fall in and answered by cursors, so
+ * neighbouring queries share cache-lines.
+ */
+class SuccinctBitVectorExecutor {
+ public:
+  static const size_t BATCH_SZ = 16384;
+
+  explicit SuccinctBitVectorExecutor(size_t nthreads = 1,
+                                     bool bucket = false) :
+      tp_(nthreads), bucket_(bucket) {}
+  ~SuccinctBitVectorExecutor() throw() {}
+
+  /* out[i] = bv.rank(pos[i], bit) */
+  void parallel_rank(const SuccinctBitVector& bv, const uint64_t *pos,
+                     size_t n, uint8_t bit, uint64_t *out) {
+    tp_.run(ntasks(n), [&](size_t t) {
+      size_t begin = t * BATCH_SZ;
+      size_t end = std::min(begin + BATCH_SZ, n);
+
+      if (!bucket_) {
+        for (size_t i = begin; i < end; i++)
+          out[i] = bv.rank(pos[i], bit);
+        return;
+      }
+
+      std::vector<qEntry> q = sort_queries(pos, begin, end, PRESUM_SZ);
+      RankCursor rc(bv);
+      for (size_t i = 0; i < q.size(); i++)
+        out[q[i].second] = rc.rank(pos[q[i].second], bit);
+    });
+  }
+
+  /* out[i] = bv.select(pos[i], bit) */
+  void parallel_select(const SuccinctBitVector& bv, const uint64_t *pos,
+                       size_t n, uint8_t bit, uint64_t *out) {
+    tp_.run(ntasks(n), [&](size_t t) {
+      size_t begin = t * BATCH_SZ;
+      size_t end = std::min(begin + BATCH_SZ, n);
+
+      if (!bucket_) {
+        for (size_t i = begin; i < end; i++)
+          out[i] = bv.select(pos[i], bit);
+        return;
+      }
+
+      std::vector<qEntry> q =
+          sort_queries(pos, begin, end, bv.select_sample());
+      SelectCursor sc(bv, bit);
+      for (size_t i = 0; i < q.size(); i++)
+        out[q[i].second] = sc.select(pos[q[i].second]);
+    });
+  }
+
+  /*
+   * Extract the positions of bits in [l[i], r[i]) for each i.
+   * They are stored in out from off[i] to off[i + 1].
+   */
+  void parallel_extract(const SuccinctBitVector& bv, const uint64_t *l,
+                        const uint64_t *r, size_t n, uint8_t bit,
+                        std::vector<uint64_t>& out,
+                        std::vector<uint64_t>& off) {
+    off.assign(n + 1, 0);
+
+    tp_.run(ntasks(n), [&](size_t t) {
+      size_t end = std::min((t + 1) * BATCH_SZ, n);
+      for (size_t i = t * BATCH_SZ; i < end; i++)
+        off[i + 1] = bv.count(l[i], r[i], bit);
+    });
+
+    for (size_t i = 0; i < n; i++)
+      off[i + 1] += off[i];
+
+    out.resize(off[n]);
+
+    tp_.run(ntasks(n), [&](size_t t) {
+      size_t end = std::min((t + 1) * BATCH_SZ, n);
+      for (size_t i = t * BATCH_SZ; i < end; i++)
+        bv.extract(l[i], r[i], bit, out.data() + off[i]);
+    });
+  }
+
+  size_t size() const {
+    return tp_.size();
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  typedef std::pair<uint64_t, size_t> qEntry;
+
+  static size_t ntasks(size_t n) {
+    return (n + BATCH_SZ - 1) / BATCH_SZ;
+  }
+
+  /* Sort queries in [begin, end) by pos / unit */
+  static std::vector<qEntry> sort_queries(const uint64_t *pos,
+                                          size_t begin, size_t end,
+                                          uint64_t unit) {
+    std::vector<qEntry> q;
+    q.reserve(end - begin);
+    for (size_t i = begin; i < end; i++)
+      q.push_back(qEntry(pos[i] / unit, i));
+
+    std::sort(q.begin(), q.end());
+    return q;
+  }
+
+  ThreadPool  tp_;
+  bool        bucket_;
+}; /* SuccinctBitVectorExecutor */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __SUCCINCTBITVECTOREXECUTOR_HPP__ */
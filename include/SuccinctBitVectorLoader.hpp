@@ -0,0 +1,209 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorLoader.hpp - A parallel loader for SuccinctBitVector
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __SUCCINCTBITVECTORLOADER_HPP__
+#define __SUCCINCTBITVECTORLOADER_HPP__
+
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "SuccinctBitVector.hpp"
+#include "PosixIO.hpp"
+#include "ThreadPool.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * SuccinctBitVectorLoader reads a file written by
+ * SuccinctBitVector::save() with a pool of threads issuing
+ * pread() for chunks of the sections. The rank section is read
+ * first, and the select sections that are missing in the file
+ * (or requested to be rebuilt) are built from it while the
+ * other threads are still reading the bit-array.
+ */
+class SuccinctBitVectorLoader {
+ public:
+  static const size_t CHUNK_SZ = 4 * 1024 * 1024;
+
+  explicit SuccinctBitVectorLoader(size_t nthreads = 1,
+                                   size_t chunk_sz = CHUNK_SZ) :
+      tp_(nthreads), chunk_sz_(std::max(chunk_sz, CACHELINE_SZ)) {}
+  ~SuccinctBitVectorLoader() throw() {}
+
+  void load(const char *path, SuccinctBitVector& bv,
+            bool build_select = false) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      throw "Failed to open: path";
+
+    try {
+      load(fd, bv, build_select, 0);
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+
+    close(fd);
+  }
+
+  /* Load a bit-vector saved at off of an opened file */
+  void load(int fd, SuccinctBitVector& bv,
+            bool build_select, uint64_t off) {
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+      throw "Failed to read: fd";
+
+    sHeader hdr;
+    pread_full(fd, reinterpret_cast<char *>(&hdr), sizeof(hdr), off);
+    if (hdr.magic != SBV_MAGIC || hdr.version != SBV_VERSION ||
+        hdr.nsec > SEC_NUM)
+      throw "Corrupted data: header";
+
+    std::vector<sSection> sec(hdr.nsec);
+    pread_full(fd, reinterpret_cast<char *>(sec.data()),
+               sec.size() * sizeof(sSection), off + sizeof(hdr));
+
+    for (size_t i = 0; i < sec.size(); i++)
+      sec[i].off += off;
+
+    load(fd, bv, build_select, hdr, sec,
+         static_cast<uint64_t>(st.st_size));
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  typedef struct {
+    char      *dst;
+    uint64_t  off;
+    uint64_t  size;
+    uint64_t  type;
+  } lChunk;
+
+  /* A pseudo type of the tasks to build select */
+  static const uint64_t TASK_BUILD = SEC_NUM;
+
+  void load(int fd, SuccinctBitVector& bv, bool build_select,
+            const sHeader& hdr, const std::vector<sSection>& sec,
+            uint64_t fsize) {
+    SuccinctBitVector::check_sections(sec);
+    bv.alloc(hdr);
+
+    bool build[2] = {true, true};
+    std::vector<lChunk> tasks;
+
+    /* The rank section goes first, then the build tasks */
+    for (int pass = 0; pass < 2; pass++) {
+      for (size_t i = 0; i < sec.size(); i++) {
+        uint64_t sz = 0;
+        char *data = bv.section_data(sec[i].type, sz);
+
+        if (sec[i].size != sz ||
+            sec[i].off + sz > fsize)
+          throw "Corrupted data: section";
+
+        if ((pass == 0) != (sec[i].type == SEC_RANK))
+          continue;
+
+        if (sec[i].type == SEC_SELECT0 || sec[i].type == SEC_SELECT1) {
+          if (build_select)
+            continue;
+          build[sec[i].type - SEC_SELECT0] = false;
+        }
+
+        for (uint64_t c = 0; c < sz; c += chunk_sz_) {
+          lChunk ck = {data + c, sec[i].off + c,
+                       std::min(chunk_sz_, sz - c), sec[i].type};
+          tasks.push_back(ck);
+        }
+      }
+
+      if (pass == 0) {
+        for (uint64_t bit = 0; bit <= 1; bit++) {
+          lChunk ck = {NULL, 0, 0, TASK_BUILD};
+          ck.off = bit;
+          tasks.push_back(ck);
+        }
+      }
+    }
+
+    size_t nrank = 0;
+    for (size_t i = 0; i < tasks.size(); i++) {
+      if (tasks[i].type == SEC_RANK)
+        nrank++;
+    }
+
+    /*
+     * Tasks are handed out in order, so all the rank chunks
+     * are being read when a build task starts waiting.
+     */
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    tp_.run(tasks.size(), [&](size_t i) {
+      const lChunk& ck = tasks[i];
+
+      if (ck.type == TASK_BUILD) {
+        bool b = false;
+        {
+          std::unique_lock<std::mutex> lk(mtx);
+          while (nrank != 0)
+            cv.wait(lk);
+          b = build[ck.off];
+        }
+
+        if (b)
+          bv.build_select(ck.off);
+        return;
+      }
+
+      if (ck.type != SEC_RANK) {
+        pread_full(fd, ck.dst, ck.size, ck.off);
+        return;
+      }
+
+      /* The build tasks must not wait forever on failures */
+      bool ok = false;
+      try {
+        pread_full(fd, ck.dst, ck.size, ck.off);
+        ok = true;
+      } catch (...) {}
+
+      {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (!ok)
+          build[0] = build[1] = false;
+        if (--nrank == 0)
+          cv.notify_all();
+      }
+
+      if (!ok)
+        throw "Failed to read: fd";
+    });
+
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      if (!build[bit])
+        bv.check_select(bit);
+    }
+  }
+
+  ThreadPool  tp_;
+  size_t      chunk_sz_;
+}; /* SuccinctBitVectorLoader */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __SUCCINCTBITVECTORLOADER_HPP__ */
@@ -0,0 +1,190 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorPool.hpp - A pool of many small rank/select dictionaries
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __SUCCINCTBITVECTORPOOL_HPP__
+#define __SUCCINCTBITVECTORPOOL_HPP__
+
+#include <algorithm>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+#include "ThreadPool.hpp"
+
+namespace succinct {
+namespace dense {
+
+/*
+ * A header of each bit-vector in a pool: the index of
+ * the first rBlock in the arena and the length in bits.
+ */
+typedef struct {
+  uint64_t  off;
+  uint64_t  size;
+} pHeader;
+
+/*
+ * SuccinctBitVectorPool packs many bit-vectors into a single
+ * arena of rBlocks. Each vector is a run of rBlocks followed
+ * by a sentinel, so it costs one header besides the rBlocks
+ * and has no heap object of its own. select() searches rk
+ * of the rBlocks because the vectors are expected to be small.
+ */
+class SuccinctBitVectorPool {
+ public:
+  SuccinctBitVectorPool() {}
+  ~SuccinctBitVectorPool() throw() {}
+
+  /* Functions to initialize */
+  uint64_t add(uint64_t len) {
+    pHeader hdr;
+    hdr.off = arena_.size();
+    hdr.size = len;
+
+    rBlock zero = {0, 0, 0, 0};
+    arena_.resize(hdr.off + len / PRESUM_SZ + 1, zero);
+    hdr_.push_back(hdr);
+
+    return hdr_.size() - 1;
+  }
+
+  uint64_t add(const BitVector& bv) {
+    uint64_t id = add(bv.length());
+    rBlock *rblk = &arena_[hdr_[id].off];
+
+    for (uint64_t i = 0; i < bv.bsize(); i++) {
+      if (i % 2 == 0)
+        rblk[i / 2].b0 = bv.get_block(i);
+      else
+        rblk[i / 2].b1 = bv.get_block(i);
+    }
+
+    return id;
+  }
+
+  void reserve(uint64_t nvec, uint64_t nbits) {
+    hdr_.reserve(nvec);
+    arena_.reserve(nbits / PRESUM_SZ + nvec);
+  }
+
+  void set_bit(uint64_t id, uint64_t pos, uint8_t bit) {
+    if (id >= hdr_.size())
+      throw "Invalid input: id";
+    if (pos >= hdr_[id].size)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    rBlock& rblk = arena_[hdr_[id].off + pos / PRESUM_SZ];
+    block_t& blk = (pos & BSIZE)? rblk.b1 : rblk.b0;
+    block_t mask = uint64_t(1) << (pos % BSIZE);
+
+    if (bit)
+      blk |= mask;
+    else
+      blk &= ~mask;
+  }
+
+  /* Build all the vectors in the pool with nthreads */
+  void build(size_t nthreads = 1) {
+    static const size_t BATCH_SZ = 1024;
+
+    size_t ntasks = (hdr_.size() + BATCH_SZ - 1) / BATCH_SZ;
+    ThreadPool tp(std::min(nthreads, ntasks));
+
+    tp.run(ntasks, [&](size_t t) {
+      size_t end = std::min((t + 1) * BATCH_SZ, hdr_.size());
+      for (size_t id = t * BATCH_SZ; id < end; id++)
+        rblock_build(&arena_[hdr_[id].off], rblock_num(id));
+    });
+  }
+
+  bool lookup(uint64_t id, uint64_t pos) const {
+    if (id >= hdr_.size())
+      throw "Invalid input: id";
+    if (pos >= hdr_[id].size)
+      throw "Invalid input: pos";
+
+    const rBlock& rblk = arena_[hdr_[id].off + pos / PRESUM_SZ];
+    block_t blk = (pos & BSIZE)? rblk.b1 : rblk.b0;
+    return (blk & (uint64_t(1) << (pos % BSIZE))) > 0;
+  }
+
+  /* Rank & Select operations */
+  uint64_t rank(uint64_t id, uint64_t pos, uint8_t bit) const {
+    if (id >= hdr_.size())
+      throw "Invalid input: id";
+    if (pos >= hdr_[id].size)
+      throw "Invalid input: pos";
+    if (bit > 1)
+      throw "Invalid input: bit";
+
+    pos++;
+
+    uint64_t r = rblock_rank1(
+        arena_[hdr_[id].off + pos / PRESUM_SZ], pos);
+    return (bit)? r : pos - r;
+  }
+
+  uint64_t select(uint64_t id, uint64_t pos, uint8_t bit) const {
+    if (id >= hdr_.size())
+      throw "Invalid input: id";
+    if (bit > 1)
+      throw "Invalid input: bit";
+    if (pos >= count(id, bit))
+      throw "Invalid input: pos";
+
+    const rBlock *rblk = &arena_[hdr_[id].off];
+    uint64_t rpos = rblock_search(rblk, 0,
+                                  rblock_num(id) - 1, pos, bit);
+    uint64_t rem = pos - rblock_cumltv(rblk[rpos], rpos, bit);
+
+    return rpos * PRESUM_SZ + rblock_select(rblk[rpos], rem, bit);
+  }
+
+  uint64_t length(uint64_t id) const {
+    if (id >= hdr_.size())
+      throw "Invalid input: id";
+
+    return hdr_[id].size;
+  }
+
+  uint64_t get_none(uint64_t id) const {
+    if (id >= hdr_.size())
+      throw "Invalid input: id";
+
+    return count(id, 1);
+  }
+
+  /* The number of vectors in the pool */
+  uint64_t size() const {
+    return hdr_.size();
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  uint64_t rblock_num(uint64_t id) const {
+    return hdr_[id].size / PRESUM_SZ + 1;
+  }
+
+  uint64_t count(uint64_t id, uint8_t bit) const {
+    const rBlock& rblk =
+        arena_[hdr_[id].off + rblock_num(id) - 1];
+    uint64_t r = rblk.rk + popcount64(rblk.b0) + popcount64(rblk.b1);
+    return (bit)? r : hdr_[id].size - r;
+  }
+
+  std::vector<pHeader>  hdr_;
+  std::vector<rBlock>   arena_;
+}; /* SuccinctBitVectorPool */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __SUCCINCTBITVECTORPOOL_HPP__ */
@@ -0,0 +1,231 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorTuner.hpp - A space/time tuner for rank/select layouts
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __SUCCINCTBITVECTORTUNER_HPP__
+#define __SUCCINCTBITVECTORTUNER_HPP__
+
+#include <algorithm>
+#include <vector>
+
+#include "SuccinctBitVector.hpp"
+#include "RRRSuccinctBitVector.hpp"
+#include "HybridSuccinctBitVector.hpp"
+
+namespace succinct {
+namespace dense {
+
+/* The select samples and the RRR block sizes tried */
+static const size_t TUNER_SAMPLE_MIN = 32;
+static const size_t TUNER_SAMPLE_MAX = 1024;
+static const size_t TUNER_RRR_BLOCK_MIN = 15;
+
+/* Layouts of a rank/select dictionary */
+enum {
+  LAYOUT_DENSE = 0,
+  LAYOUT_RRR,
+  LAYOUT_SPARSE,
+  LAYOUT_RLE,
+  LAYOUT_HYBRID,
+  LAYOUT_NUM
+};
+
+/*
+ * A layout with its parameter, that is, the select sample for
+ * LAYOUT_DENSE and the block size for LAYOUT_RRR, and estimates
+ * of its space in bytes and its cost, the number of cache-lines
+ * loaded by a rank and a select.
+ */
+typedef struct {
+  uint64_t  layout;
+  uint64_t  param;
+  uint64_t  space;
+  uint64_t  cost;
+} tChoice;
+
+/*
+ * SuccinctBitVectorTuner estimates the space and the cost of
+ * the layouts from dStats, gathered by SuccinctBitVector::build(),
+ * and picks one for a memory budget or a target cost. The bits
+ * are assumed to be spread evenly in the estimates. A dense
+ * choice is applied by build(param), and the sample is kept in
+ * the header of save(). Other choices are only advisory: the
+ * caller builds the vector of that layout, and nothing records
+ * the choice in a dense vector.
+ */
+class SuccinctBitVectorTuner {
+ public:
+  static std::vector<tChoice> candidates(const dStats& st) {
+    if (st.size == 0 || st.none > st.size)
+      throw "Invalid input: st";
+
+    std::vector<tChoice> c;
+    for (size_t s = TUNER_SAMPLE_MIN; s <= TUNER_SAMPLE_MAX; s *= 2)
+      c.push_back(dense_choice(st, s));
+    for (size_t b = TUNER_RRR_BLOCK_MIN; b < BSIZE; b = b * 2 + 1)
+      c.push_back(rrr_choice(st, b));
+
+    c.push_back(sparse_choice(st));
+    c.push_back(rle_choice(st));
+    c.push_back(hybrid_choice(st));
+    return c;
+  }
+
+  /* The fastest in budget bytes, or the smallest if none fits */
+  static tChoice tune_space(const dStats& st, uint64_t budget) {
+    std::vector<tChoice> c = candidates(st);
+
+    size_t best = 0;
+    for (size_t i = 1; i < c.size(); i++) {
+      bool fit = c[i].space <= budget;
+      bool bfit = c[best].space <= budget;
+      if ((fit && !bfit) ||
+          (fit && bfit && less(c[i].cost, c[i].space,
+                               c[best].cost, c[best].space)) ||
+          (!fit && !bfit && c[i].space < c[best].space))
+        best = i;
+    }
+
+    return c[best];
+  }
+
+  /* The smallest within cost, or the fastest if none is in it */
+  static tChoice tune_latency(const dStats& st, uint64_t cost) {
+    std::vector<tChoice> c = candidates(st);
+
+    size_t best = 0;
+    for (size_t i = 1; i < c.size(); i++) {
+      bool fit = c[i].cost <= cost;
+      bool bfit = c[best].cost <= cost;
+      if ((fit && !bfit) ||
+          (fit && bfit && less(c[i].space, c[i].cost,
+                               c[best].space, c[best].cost)) ||
+          (!fit && !bfit && c[i].cost < c[best].cost))
+        best = i;
+    }
+
+    return c[best];
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  static bool less(uint64_t a0, uint64_t a1, uint64_t b0, uint64_t b1) {
+    return a0 < b0 || (a0 == b0 && a1 < b1);
+  }
+
+  static uint64_t log2ceil(uint64_t x) {
+    return (x > 1)? BSIZE - __builtin_clzll(x - 1) : 0;
+  }
+
+  static uint64_t dense_space(uint64_t size, uint64_t none,
+                              size_t sample) {
+    uint64_t nhints = (none + sample - 1) / sample +
+        (size - none + sample - 1) / sample + 2;
+    return (size + BSIZE - 1) / BSIZE * sizeof(block_t) +
+        (size / PRESUM_SZ + 1) * sizeof(rBlock) +
+        nhints * sizeof(uint64_t);
+  }
+
+  /*
+   * A select loads a hint and searches the rBlocks between two
+   * hints until a cache-line of them is left.
+   */
+  static uint64_t dense_select(uint64_t size, uint64_t n, size_t sample) {
+    if (n == 0)
+      return 0;
+
+    uint64_t span = (sample * size + PRESUM_SZ * n - 1) / (PRESUM_SZ * n);
+    uint64_t line = CACHELINE_SZ / sizeof(rBlock);
+    return 2 + log2ceil((span + line - 1) / line);
+  }
+
+  static tChoice dense_choice(const dStats& st, size_t sample) {
+    tChoice c = {LAYOUT_DENSE, sample,
+                 dense_space(st.size, st.none, sample), 1};
+    c.cost += (dense_select(st.size, st.none, sample) +
+               dense_select(st.size, st.size - st.none, sample)) / 2;
+    return c;
+  }
+
+  /*
+   * A query loads a sample, scans half of its classes, and
+   * decodes an offset in a step per bit, 8 steps of which are
+   * counted as a cache-line.
+   */
+  static tChoice rrr_choice(const dStats& st, size_t bsz) {
+    uint64_t nblocks = (st.size + bsz - 1) / bsz;
+    uint64_t nsamples = nblocks / rrr::RRR_SAMPLE_SZ + 2;
+    size_t cw = BSIZE - __builtin_clzll(bsz);
+    size_t k = (st.none * bsz + st.size / 2) / st.size;
+
+    uint64_t bits = nblocks * (cw + rrr::offset_width(bsz, k));
+    uint64_t scan = rrr::RRR_SAMPLE_SZ / 2 * cw / (CACHELINE_SZ * 8) + 1;
+
+    tChoice c = {LAYOUT_RRR, bsz,
+                 (bits / BSIZE + 3 + nsamples * 2) * sizeof(uint64_t),
+                 2 * (scan + 1 + bsz / 8) + log2ceil(nsamples)};
+    return c;
+  }
+
+  static uint64_t sparse_space(uint64_t size, uint64_t n) {
+    uint64_t q = (n)? size / n : size;
+    size_t lw = (q > 1)? BSIZE - 1 - __builtin_clzll(q) : 0;
+    uint64_t hlen = n + (size >> lw) + 1;
+    return ((n * lw + BSIZE - 1) / BSIZE + 1) * sizeof(block_t) +
+        dense_space(hlen, n, SELECT_SAMPLE_SZ);
+  }
+
+  /*
+   * Selects of ones load the upper and the lower bits, rank
+   * selects zeros twice in the upper bits, and selects of zeros
+   * search the ones.
+   */
+  static tChoice sparse_choice(const dStats& st) {
+    uint64_t sel = 4;
+    tChoice c = {LAYOUT_SPARSE, 0, sparse_space(st.size, st.none),
+                 2 * sel + (sel + sel * log2ceil(st.none + 1)) / 2};
+    return c;
+  }
+
+  /* Queries are a few queries on two sparse vectors */
+  static tChoice rle_choice(const dStats& st) {
+    uint64_t sel = 4;
+    uint64_t rk = 2 * sel;
+    tChoice c = {LAYOUT_RLE, 0,
+                 sparse_space(st.size, st.nruns) +
+                 ((st.none)? sparse_space(st.none, st.nruns) : 0),
+                 rk + 3 * sel +
+                 (rk + 2 * sel + 2 * sel * log2ceil(st.nruns + 1)) / 2};
+    return c;
+  }
+
+  /* Groups are assumed to have the same density */
+  static tChoice hybrid_choice(const dStats& st) {
+    uint64_t ngroups = (st.size + hybrid::HYBRID_GROUP_SZ - 1) /
+        hybrid::HYBRID_GROUP_SZ;
+
+    uint64_t gsz = 0;
+    if (st.none != 0 && st.none != st.size) {
+      uint64_t raw = hybrid::HYBRID_GROUP_SZ / 8;
+      uint64_t ones = (st.none + ngroups - 1) / ngroups;
+      uint64_t runs = (st.nruns + ngroups - 1) / ngroups;
+      gsz = std::min(raw, std::min(ones * 2, runs * 4));
+    }
+
+    tChoice c = {LAYOUT_HYBRID, 0,
+                 (ngroups + 1) * sizeof(hybrid::hEntry) + ngroups * gsz,
+                 4 + (log2ceil(ngroups) + 2) / 2};
+    return c;
+  }
+}; /* SuccinctBitVectorTuner */
+
+} /* dense */
+} /* succinct */
+
+#endif /* __SUCCINCTBITVECTORTUNER_HPP__ */
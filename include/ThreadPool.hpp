@@ -0,0 +1,154 @@
+/*-----------------------------------------------------------------------------
+ *  ThreadPool.hpp - A minimal thread pool for batch operations
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __THREADPOOL_HPP__
+#define __THREADPOOL_HPP__
+
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace succinct {
+
+/*
+ * A pool of workers that run task indices [0, ntasks) of one
+ * job at a time. Tasks are handed out by an atomic counter,
+ * so skewed tasks are balanced among workers dynamically.
+ * The calling thread of run() also works on the job.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t nthreads) :
+      stop_(false), gen_(0), nbusy_(0),
+      ntasks_(0), fn_(NULL), next_(0) {
+    for (size_t i = 1; i < nthreads; i++)
+      workers_.push_back(std::thread(&ThreadPool::loop, this));
+  }
+
+  ~ThreadPool() throw() {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      stop_ = true;
+    }
+
+    wake_.notify_all();
+
+    for (size_t i = 0; i < workers_.size(); i++)
+      workers_[i].join();
+  }
+
+  /*
+   * Run fn(i) for each i in [0, ntasks) and wait for all
+   * of them. An exception thrown by a task is re-thrown here.
+   */
+  void run(size_t ntasks, const std::function<void(size_t)>& fn) {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      fn_ = &fn;
+      ntasks_ = ntasks;
+      next_ = 0;
+      nbusy_ = workers_.size();
+      error_ = std::exception_ptr();
+      gen_++;
+    }
+
+    wake_.notify_all();
+    work(fn, ntasks);
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (nbusy_ != 0)
+      done_.wait(lk);
+
+    fn_ = NULL;
+
+    if (error_) {
+      std::exception_ptr e = error_;
+      error_ = std::exception_ptr();
+      std::rethrow_exception(e);
+    }
+  }
+
+  size_t size() const {
+    return workers_.size() + 1;
+  }
+
+ private:
+  /*--- Private functions below ---*/
+  void loop() {
+    uint64_t seen = 0;
+
+    for (;;) {
+      const std::function<void(size_t)> *fn = NULL;
+      size_t ntasks = 0;
+
+      {
+        std::unique_lock<std::mutex> lk(mtx_);
+        while (!stop_ && gen_ == seen)
+          wake_.wait(lk);
+
+        if (stop_)
+          return;
+
+        seen = gen_;
+        fn = fn_;
+        ntasks = ntasks_;
+      }
+
+      work(*fn, ntasks);
+
+      std::lock_guard<std::mutex> lk(mtx_);
+      if (--nbusy_ == 0)
+        done_.notify_one();
+    }
+  }
+
+  void work(const std::function<void(size_t)>& fn, size_t ntasks) {
+    for (;;) {
+      size_t i = next_.fetch_add(1);
+      if (i >= ntasks)
+        break;
+
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!error_)
+          error_ = std::current_exception();
+      }
+    }
+  }
+
+  bool      stop_;
+  uint64_t  gen_;
+  size_t    nbusy_;
+  size_t    ntasks_;
+
+  const std::function<void(size_t)> *fn_;
+
+  std::atomic<size_t>       next_;
+  std::exception_ptr        error_;
+  std::mutex                mtx_;
+  std::condition_variable   wake_;
+  std::condition_variable   done_;
+  std::vector<std::thread>  workers_;
+
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+}; /* ThreadPool */
+
+} /* succinct */
+
+#endif /* __THREADPOOL_HPP__ */
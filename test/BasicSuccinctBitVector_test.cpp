@@ -0,0 +1,114 @@
+/*-----------------------------------------------------------------------------
+ *  BasicSuccinctBitVector_test.cpp - A unit test for the policy-based vector
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "BasicSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+using succinct::dense::BasicSuccinctBitVector;
+using succinct::dense::InterleavedLayout;
+using succinct::dense::FlatLayout;
+using succinct::dense::SampledSelect;
+using succinct::dense::BinarySearchSelect;
+using succinct::dense::BuiltinPopcount;
+using succinct::dense::SwarPopcount;
+
+static const size_t BASIC_SZ = 1000000;
+
+/* Count the calls to see that a layout uses the policy */
+class CountingPopcount {
+ public:
+  static uint64_t count(succinct::dense::block_t b) {
+    ncalls++;
+    return succinct::dense::popcount64(b);
+  }
+
+  static uint64_t ncalls;
+};
+
+uint64_t CountingPopcount::ncalls = 0;
+
+template<class T>
+class BasicSuccinctBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    XorShift rnd;
+
+    bits.resize(BASIC_SZ);
+    bv.init(BASIC_SZ);
+    sbv.init(BASIC_SZ);
+
+    /* Dense bits and then sparse bits */
+    for (uint64_t i = 0; i < BASIC_SZ; i++) {
+      uint32_t x = rnd.next();
+      bits[i] = (i < BASIC_SZ / 2)? x % 2 : x % 1000 == 0;
+      bv.set_bit(i, bits[i]);
+      sbv.set_bit(i, bits[i]);
+    }
+
+    bv.build();
+    sbv.build();
+  }
+
+  virtual void TearDown() {}
+
+  T bv;
+  succinct::dense::SuccinctBitVector sbv;
+  std::vector<bool> bits;
+};
+
+typedef ::testing::Types<
+    succinct::dense::DefaultSuccinctBitVector,
+    BasicSuccinctBitVector<InterleavedLayout, BinarySearchSelect,
+                           SwarPopcount>,
+    BasicSuccinctBitVector<FlatLayout<>, SampledSelect<32>,
+                           BuiltinPopcount>,
+    BasicSuccinctBitVector<FlatLayout<512>, BinarySearchSelect,
+                           SwarPopcount> > BasicTypes;
+
+TYPED_TEST_CASE(BasicSuccinctBVTest, BasicTypes);
+
+TYPED_TEST(BasicSuccinctBVTest, rank_and_select) {
+  check_rank_select(this->bv, this->bits);
+  EXPECT_EQ(this->sbv.get_none(), this->bv.get_none());
+  EXPECT_ANY_THROW(this->bv.set_bit(0, 1));
+}
+
+TYPED_TEST(BasicSuccinctBVTest, same_as_dense) {
+  /* Any policies answer as SuccinctBitVector does */
+  for (uint64_t i = 0; i < BASIC_SZ; i += 7) {
+    ASSERT_EQ(this->sbv.rank(i, 1), this->bv.rank(i, 1));
+    if (i < this->sbv.get_none()) {
+      ASSERT_EQ(this->sbv.select(i, 1), this->bv.select(i, 1));
+    }
+  }
+}
+
+template<class L>
+static void check_select_policy() {
+  BasicSuccinctBitVector<L, BinarySearchSelect, CountingPopcount> bv;
+  bv.init(BASIC_SZ);
+  for (uint64_t i = 0; i < BASIC_SZ; i += 3)
+    bv.set_bit(i, 1);
+  bv.build();
+
+  /* Select counts the bytes of a block by the policy */
+  CountingPopcount::ncalls = 0;
+  for (uint64_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(3 * i, bv.select(i, 1));
+    ASSERT_EQ(i + i / 2 + 1, bv.select(i, 0));
+  }
+  EXPECT_LE(2000U, CountingPopcount::ncalls);
+}
+
+TEST(BasicSuccinctBVPolicyTest, select) {
+  check_select_policy<InterleavedLayout>();
+  check_select_policy<FlatLayout<> >();
+}
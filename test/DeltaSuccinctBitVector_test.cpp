@@ -0,0 +1,125 @@
+/*-----------------------------------------------------------------------------
+ *  DeltaSuccinctBitVector_test.cpp - A unit test for delta updates
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "DeltaSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t DELTA_SZ = 300000;
+static const size_t DELTA_UPDATE_NUM = 20000;
+
+class DeltaSuccinctBVTest : public ::testing::Test {
+ public:
+  DeltaSuccinctBVTest() : rnd(88675123) {}
+
+  virtual void SetUp() {
+    bits.resize(DELTA_SZ);
+    sbv.init(DELTA_SZ);
+    for (uint64_t i = 0; i < DELTA_SZ; i++) {
+      bits[i] = rnd.next() % 3 == 0;
+      sbv.set_bit(i, bits[i]);
+    }
+
+    sbv.build();
+  }
+
+  virtual void TearDown() {}
+
+  void update(succinct::dense::DeltaSuccinctBitVector& dbv, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      /* Half of the updates hit a small region */
+      uint64_t pos = (i % 2)? rnd.next() % DELTA_SZ :
+          1000 + rnd.next() % 500;
+      switch (i % 3) {
+        case 0: dbv.flip(pos); bits[pos] = !bits[pos]; break;
+        case 1: dbv.set(pos); bits[pos] = true; break;
+        case 2: dbv.clear(pos); bits[pos] = false; break;
+      }
+    }
+  }
+
+  /* Merges keep the stats of the base without a full pass */
+  void check_stats(const succinct::dense::SuccinctBitVector& bv) {
+    uint64_t nruns = 0;
+    for (uint64_t i = 0; i < DELTA_SZ; i++)
+      nruns += bits[i] && (i == 0 || !bits[i - 1]);
+
+    EXPECT_EQ(DELTA_SZ, bv.stats().size);
+    EXPECT_EQ(bv.get_none(), bv.stats().none);
+    EXPECT_EQ(nruns, bv.stats().nruns);
+  }
+
+  XorShift rnd;
+  succinct::dense::SuccinctBitVector sbv;
+  std::vector<bool> bits;
+};
+
+TEST_F(DeltaSuccinctBVTest, delta) {
+  std::vector<bool> orig = bits;
+  uint64_t none = sbv.get_none();
+
+  succinct::dense::DeltaSuccinctBitVector dbv(sbv, DELTA_UPDATE_NUM * 2);
+  update(dbv, DELTA_UPDATE_NUM);
+
+  EXPECT_FALSE(dbv.merging());
+  EXPECT_NE(0U, dbv.delta_num());
+  check_rank_select(dbv, bits);
+
+  /* The base is shared with sbv, and not changed by a merge */
+  const succinct::dense::SuccinctBitVector& fbv = dbv.freeze();
+  EXPECT_EQ(0U, dbv.delta_num());
+  EXPECT_EQ(dbv.get_none(), fbv.get_none());
+  EXPECT_NE(sbv.get_none(), fbv.get_none());
+  check_rank_select(dbv, bits);
+  check_stats(fbv);
+
+  EXPECT_EQ(none, sbv.get_none());
+  for (uint64_t i = 0; i < DELTA_SZ; i++)
+    ASSERT_EQ(orig[i], sbv.lookup(i)) << "Position: " << i;
+
+  EXPECT_ANY_THROW(dbv.flip(DELTA_SZ));
+  EXPECT_ANY_THROW(dbv.set_bit(0, 2));
+}
+
+TEST_F(DeltaSuccinctBVTest, merge) {
+  succinct::dense::DeltaSuccinctBitVector dbv(256);
+  dbv.init(DELTA_SZ);
+  for (uint64_t i = 0; i < DELTA_SZ; i++)
+    dbv.set_bit(i, bits[i]);
+
+  EXPECT_ANY_THROW(dbv.rank(0, 1));
+  dbv.build();
+
+  /* Updates and queries go on while merges run */
+  for (size_t i = 0; i < 10; i++) {
+    update(dbv, DELTA_UPDATE_NUM / 10);
+
+    for (size_t j = 0; j < 100; j++) {
+      uint64_t pos = rnd.next() % DELTA_SZ;
+      ASSERT_EQ(bits[pos], dbv.lookup(pos)) << "Position: " << pos;
+      ASSERT_EQ(pos, dbv.select(dbv.rank(pos, bits[pos]) - 1, bits[pos]))
+          << "Position: " << pos;
+    }
+  }
+
+  check_rank_select(dbv, bits);
+
+  dbv.wait_merge();
+  EXPECT_FALSE(dbv.merging());
+  check_rank_select(dbv, bits);
+
+  /* An explicit merge is done in place before returning */
+  update(dbv, 100);
+  dbv.merge();
+  EXPECT_FALSE(dbv.merging());
+  EXPECT_EQ(0U, dbv.delta_num());
+  check_rank_select(dbv, bits);
+  check_stats(dbv.freeze());
+}
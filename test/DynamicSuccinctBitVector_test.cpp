@@ -0,0 +1,104 @@
+/*-----------------------------------------------------------------------------
+ *  DynamicSuccinctBitVector_test.cpp - A unit test for insertions and erasures
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "DynamicSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t DYNAMIC_SZ = 200000;
+static const size_t DYNAMIC_OP_NUM = 100000;
+
+class DynamicSuccinctBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+
+  void check(const succinct::dense::DynamicSuccinctBitVector& dbv) {
+    ASSERT_EQ(bits.size(), dbv.length());
+    check_rank_select(dbv, bits);
+  }
+
+  XorShift rnd;
+  std::vector<uint8_t> bits;
+};
+
+TEST_F(DynamicSuccinctBVTest, insert_and_erase) {
+  succinct::dense::DynamicSuccinctBitVector dbv;
+
+  /* Grow with insertions at random positions */
+  for (size_t i = 0; i < DYNAMIC_SZ; i++) {
+    uint64_t pos = rnd.next() % (bits.size() + 1);
+    uint8_t bit = rnd.next() % 2;
+    dbv.insert(pos, bit);
+    bits.insert(bits.begin() + pos, bit);
+  }
+
+  check(dbv);
+
+  /* Mix updates with a bias to erasures */
+  for (size_t i = 0; i < DYNAMIC_OP_NUM; i++) {
+    uint64_t pos = rnd.next() % bits.size();
+    switch (rnd.next() % 4) {
+      case 0:
+        dbv.insert(pos, 1);
+        bits.insert(bits.begin() + pos, 1);
+        break;
+      case 1:
+        dbv.set_bit(pos, !bits[pos]);
+        bits[pos] = !bits[pos];
+        break;
+      default:
+        dbv.erase(pos);
+        bits.erase(bits.begin() + pos);
+        break;
+    }
+  }
+
+  check(dbv);
+
+  /* Shrink to a few bits, and collapse the tree */
+  while (bits.size() > 10) {
+    uint64_t pos = rnd.next() % bits.size();
+    dbv.erase(pos);
+    bits.erase(bits.begin() + pos);
+  }
+
+  check(dbv);
+  EXPECT_ANY_THROW(dbv.erase(bits.size()));
+  EXPECT_ANY_THROW(dbv.insert(bits.size() + 1, 0));
+}
+
+TEST_F(DynamicSuccinctBVTest, build_and_freeze) {
+  succinct::dense::SuccinctBitVector sbv;
+  sbv.init(DYNAMIC_SZ);
+  for (uint64_t i = 0; i < DYNAMIC_SZ; i++) {
+    bits.push_back(rnd.next() % 3 == 0);
+    sbv.set_bit(i, bits.back());
+  }
+
+  sbv.build();
+
+  succinct::dense::DynamicSuccinctBitVector dbv(sbv);
+  check(dbv);
+
+  /* Insert at the front and the end */
+  for (size_t i = 0; i < DYNAMIC_SZ / 10; i++) {
+    uint64_t pos = (i % 2)? bits.size() : 0;
+    dbv.insert(pos, i % 3 == 0);
+    bits.insert(bits.begin() + pos, i % 3 == 0);
+  }
+
+  check(dbv);
+
+  succinct::dense::SuccinctBitVector fbv;
+  dbv.freeze(fbv);
+  ASSERT_EQ(bits.size(), fbv.length());
+  check_rank_select(fbv, bits);
+}
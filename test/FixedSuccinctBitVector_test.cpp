@@ -0,0 +1,67 @@
+/*-----------------------------------------------------------------------------
+ *  FixedSuccinctBitVector_test.cpp - A unit test for the fixed-size vector
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "FixedSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+using succinct::dense::FixedSuccinctBitVector;
+
+/* Queries in constant expressions */
+static constexpr FixedSuccinctBitVector<100> FIXED_BV(
+    std::array<uint64_t, 2>{{0x5ULL, 0x1ULL}});
+
+static_assert(FIXED_BV.get_none() == 3, "get_none");
+static_assert(FIXED_BV.rank(2, 1) == 2, "rank");
+static_assert(FIXED_BV.select(2, 1) == 64, "select");
+static_assert(FIXED_BV.select(1, 0) == 3, "select0");
+
+static constexpr FixedSuccinctBitVector<1024> FIXED_DIR_BV(
+    std::array<uint64_t, 16>{{1, 0, 0, 0, 0, 0, 0, 0, 3}});
+
+static_assert(FIXED_DIR_BV.rank(1023, 1) == 3, "rank with directory");
+static_assert(FIXED_DIR_BV.select(2, 1) == 513, "select with directory");
+
+/* The count of ones is padded to a whole block */
+static_assert(sizeof(FixedSuccinctBitVector<512>) ==
+              sizeof(uint64_t) * (512 / 64 + 1), "no directory");
+static_assert(sizeof(FixedSuccinctBitVector<2048>) ==
+              sizeof(uint64_t) * (2048 / 64 + 2), "with directory");
+
+template<size_t N>
+static void check_fixed(uint32_t seed) {
+  FixedSuccinctBitVector<N> bv;
+  std::vector<bool> bits(N);
+  XorShift rnd(seed);
+
+  /* Set bits twice to check updates of the directory */
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint64_t i = 0; i < N; i++) {
+      bits[i] = rnd.next() % 3 == 0;
+      bv.set_bit(i, bits[i]);
+    }
+  }
+
+  SCOPED_TRACE(N);
+  check_rank_select(bv, bits);
+  EXPECT_ANY_THROW(bv.rank(N, 1));
+  EXPECT_ANY_THROW(bv.set_bit(N, 1));
+}
+
+TEST(FixedSuccinctBVTest, rank_and_select) {
+  check_fixed<1>(1);
+  check_fixed<64>(2);
+  check_fixed<100>(3);
+  check_fixed<512>(4);
+  check_fixed<513>(5);
+  check_fixed<1024>(6);
+  check_fixed<4096>(7);
+  check_fixed<65535>(8);
+}
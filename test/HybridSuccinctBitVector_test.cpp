@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------------------------
+ *  HybridSuccinctBitVector_test.cpp - A unit test for the hybrid vector
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "HybridSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+using succinct::hybrid::HB_ZEROS;
+using succinct::hybrid::HB_ONES;
+using succinct::hybrid::HB_RAW;
+using succinct::hybrid::HB_SPARSE;
+using succinct::hybrid::HB_RUNS;
+
+static const size_t HYBRID_SZ = 500000;
+static const size_t HYBRID_REGION_SZ = 10000;
+
+class HybridSuccinctBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    XorShift rnd;
+
+    bits.resize(HYBRID_SZ);
+    bv.init(HYBRID_SZ);
+
+    /* Regions of random, sparse, empty, full and run-heavy bits */
+    uint64_t run = 0;
+    for (uint64_t i = 0; i < HYBRID_SZ; i++) {
+      uint32_t x = rnd.next();
+
+      switch ((i / HYBRID_REGION_SZ) % 5) {
+        case 0: bits[i] = x % 2; break;
+        case 1: bits[i] = (x % 500 == 0); break;
+        case 2: bits[i] = false; break;
+        case 3: bits[i] = true; break;
+        case 4:
+          if (run == 0)
+            run = x % 300 + 1;
+          run--;
+          bits[i] = (i / 300) % 2;
+          break;
+      }
+
+      bv.set_bit(i, bits[i]);
+    }
+
+    bv.build();
+  }
+
+  virtual void TearDown() {}
+
+  succinct::hybrid::SuccinctBitVector bv;
+  std::vector<bool> bits;
+};
+
+TEST_F(HybridSuccinctBVTest, encodings) {
+  EXPECT_LT(0U, bv.group_num(HB_ZEROS));
+  EXPECT_LT(0U, bv.group_num(HB_ONES));
+  EXPECT_LT(0U, bv.group_num(HB_RAW));
+  EXPECT_LT(0U, bv.group_num(HB_SPARSE));
+  EXPECT_LT(0U, bv.group_num(HB_RUNS));
+
+  /* Smaller than the plain bits */
+  EXPECT_GT(HYBRID_SZ / 8, bv.space());
+}
+
+TEST_F(HybridSuccinctBVTest, rank_and_select) {
+  check_rank_select(bv, bits);
+}
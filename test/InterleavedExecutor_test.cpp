@@ -0,0 +1,99 @@
+/*-----------------------------------------------------------------------------
+ *  InterleavedExecutor_test.cpp - A unit test for InterleavedExecutor.hpp
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "InterleavedExecutor.hpp"
+#include "TestUtil.hpp"
+
+using succinct::dense::qQuery;
+using succinct::dense::QUERY_NONE;
+using succinct::dense::QUERY_RANK;
+using succinct::dense::QUERY_SELECT;
+
+static const size_t INTERLEAVED_SZ = 1000000;
+static const size_t INTERLEAVED_NCHAIN = 1000;
+
+class InterleavedExecutorTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bv.init(INTERLEAVED_SZ);
+
+    XorShift rnd;
+    for (uint64_t i = 0; i < INTERLEAVED_SZ; i++) {
+      if (rnd.next() % 3 == 0)
+        bv.set_bit(i, 1);
+    }
+
+    bv.build();
+  }
+
+  virtual void TearDown() {}
+
+  /*
+   * A chain alternates rank and select, each depending on the
+   * last result, and ends after (id % 7) * 2 + 1 queries.
+   */
+  bool step(size_t id, qQuery& q) {
+    uint64_t n = (q.op == QUERY_NONE)? 0 : ++nq[id];
+    if (n == (id % 7) * 2 + 1)
+      return false;
+
+    if (q.op == QUERY_NONE) {
+      q.op = QUERY_RANK, q.bit = id % 2;
+      q.pos = (id * 7919) % INTERLEAVED_SZ;
+    } else if (q.op == QUERY_RANK) {
+      uint64_t nbits = (q.bit)? bv.get_none() :
+          INTERLEAVED_SZ - bv.get_none();
+      q.op = QUERY_SELECT, q.pos = (q.ret * 3) % nbits;
+    } else {
+      q.op = QUERY_RANK, q.bit ^= 1, q.pos = q.ret;
+    }
+
+    return true;
+  }
+
+  succinct::dense::SuccinctBitVector bv;
+  std::vector<uint64_t> nq;
+};
+
+TEST_F(InterleavedExecutorTest, run) {
+  /* Results of the chains run one by one */
+  std::vector<std::vector<uint64_t> > expected(INTERLEAVED_NCHAIN);
+  nq.assign(INTERLEAVED_NCHAIN, 0);
+  for (size_t id = 0; id < INTERLEAVED_NCHAIN; id++) {
+    qQuery q;
+    q.op = QUERY_NONE;
+    while (step(id, q)) {
+      q.ret = (q.op == QUERY_RANK)? bv.rank(q.pos, q.bit) :
+          bv.select(q.pos, q.bit);
+      expected[id].push_back(q.ret);
+    }
+  }
+
+  for (size_t group_sz = 1; group_sz <= 64; group_sz *= 4) {
+    succinct::dense::InterleavedExecutor exec(bv, group_sz);
+    std::vector<std::vector<uint64_t> > ret(INTERLEAVED_NCHAIN);
+
+    nq.assign(INTERLEAVED_NCHAIN, 0);
+    exec.run(INTERLEAVED_NCHAIN, [&](size_t id, qQuery& q) {
+      if (q.op != QUERY_NONE)
+        ret[id].push_back(q.ret);
+      return step(id, q);
+    });
+
+    EXPECT_EQ(expected, ret) << "Group: " << group_sz;
+  }
+
+  succinct::dense::InterleavedExecutor exec(bv);
+  EXPECT_ANY_THROW(exec.run(1, [&](size_t id, qQuery& q) {
+    q.op = QUERY_SELECT, q.bit = 1, q.pos = INTERLEAVED_SZ;
+    return true;
+  }));
+}
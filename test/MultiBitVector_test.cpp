@@ -0,0 +1,81 @@
+/*-----------------------------------------------------------------------------
+ *  MultiBitVector_test.cpp - A unit test for MultiBitVector.hpp
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "MultiBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t MULTI_K = 3;
+static const uint64_t MULTI_SZ = 100000;
+
+class MultiBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    XorShift rnd;
+
+    mbv.init(MULTI_SZ);
+
+    /* Densities vary among the vectors */
+    for (size_t k = 0; k < MULTI_K; k++) {
+      uint32_t thres = (k * 2 + 1) * (UINT32_MAX / 8);
+
+      bits[k].resize(MULTI_SZ);
+      for (uint64_t i = 0; i < MULTI_SZ; i++) {
+        bits[k][i] = (rnd.next() < thres);
+        mbv.set_bit(k, i, bits[k][i]);
+      }
+    }
+
+    mbv.build();
+  }
+
+  virtual void TearDown() {}
+
+  succinct::dense::MultiBitVector<MULTI_K> mbv;
+  std::vector<bool> bits[MULTI_K];
+};
+
+TEST_F(MultiBVTest, rank) {
+  uint64_t nrank[MULTI_K] = {0};
+
+  for (uint64_t i = 0; i < MULTI_SZ; i++) {
+    uint64_t mask = 0;
+    for (size_t k = 0; k < MULTI_K; k++) {
+      EXPECT_EQ(bits[k][i], mbv.lookup(k, i));
+      mask |= uint64_t(bits[k][i]) << k;
+      nrank[k] += bits[k][i];
+    }
+
+    EXPECT_EQ(mask, mbv.lookup_all(i));
+
+    std::array<uint64_t, MULTI_K> r1 = mbv.rank_all(i, 1);
+    std::array<uint64_t, MULTI_K> r0 = mbv.rank_all(i, 0);
+    for (size_t k = 0; k < MULTI_K; k++) {
+      EXPECT_EQ(nrank[k], r1[k]);
+      EXPECT_EQ(i + 1 - nrank[k], r0[k]);
+      EXPECT_EQ(nrank[k], mbv.rank(k, i, 1));
+    }
+  }
+
+  for (size_t k = 0; k < MULTI_K; k++)
+    EXPECT_EQ(nrank[k], mbv.get_none(k));
+
+  EXPECT_ANY_THROW(mbv.rank_all(MULTI_SZ, 1));
+  EXPECT_ANY_THROW(mbv.rank(MULTI_K, 0, 1));
+}
+
+TEST_F(MultiBVTest, select) {
+  typedef IdView<succinct::dense::MultiBitVector<MULTI_K> > View;
+
+  for (size_t k = 0; k < MULTI_K; k++) {
+    SCOPED_TRACE(k);
+    check_rank_select(View(mbv, k), bits[k]);
+  }
+}
@@ -0,0 +1,74 @@
+/*-----------------------------------------------------------------------------
+ *  MutableSuccinctBitVector_test.cpp - A unit test for updates after build
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "MutableSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t MUTABLE_SZ = 1000000;
+static const size_t MUTABLE_UPDATE_NUM = 20000;
+
+class MutableSuccinctBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bits.resize(MUTABLE_SZ);
+    sbv.init(MUTABLE_SZ);
+    for (uint64_t i = 0; i < MUTABLE_SZ; i++) {
+      bits[i] = rnd.next() % 2;
+      sbv.set_bit(i, bits[i]);
+    }
+
+    sbv.build();
+  }
+
+  virtual void TearDown() {}
+
+  XorShift rnd;
+  succinct::dense::SuccinctBitVector sbv;
+  std::vector<bool> bits;
+};
+
+TEST_F(MutableSuccinctBVTest, update) {
+  succinct::dense::MutableSuccinctBitVector mbv(sbv);
+  check_rank_select(mbv, bits);
+
+  for (size_t i = 0; i < MUTABLE_UPDATE_NUM; i++) {
+    uint64_t pos = rnd.next() % MUTABLE_SZ;
+    switch (i % 3) {
+      case 0: mbv.flip(pos); bits[pos] = !bits[pos]; break;
+      case 1: mbv.set(pos); bits[pos] = true; break;
+      case 2: mbv.clear(pos); bits[pos] = false; break;
+    }
+  }
+
+  check_rank_select(mbv, bits);
+  EXPECT_ANY_THROW(mbv.flip(MUTABLE_SZ));
+}
+
+TEST_F(MutableSuccinctBVTest, freeze) {
+  succinct::dense::MutableSuccinctBitVector mbv;
+  mbv.init(MUTABLE_SZ);
+  for (uint64_t i = 0; i < MUTABLE_SZ; i++)
+    mbv.set_bit(i, bits[i]);
+  EXPECT_ANY_THROW(mbv.rank(0, 1));
+  mbv.build();
+
+  /* Flip every 1000th bit, and freeze the result */
+  for (uint64_t i = 0; i < MUTABLE_SZ; i += 1000) {
+    mbv.flip(i);
+    bits[i] = !bits[i];
+  }
+
+  succinct::dense::SuccinctBitVector fbv;
+  mbv.freeze(fbv);
+
+  EXPECT_EQ(mbv.get_none(), fbv.stats().none);
+  check_rank_select(fbv, bits);
+}
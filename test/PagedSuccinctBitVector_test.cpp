@@ -0,0 +1,127 @@
+/*-----------------------------------------------------------------------------
+ *  PagedSuccinctBitVector_test.cpp - A unit test for PagedSuccinctBitVector.hpp
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "PagedSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t PAGED_SZ = 1000003;
+
+class PagedSuccinctBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bits.resize(PAGED_SZ);
+    bv.init(PAGED_SZ);
+
+    /* Sparse, dense and random regions */
+    XorShift rnd(2463534242U);
+    for (uint64_t i = 0; i < PAGED_SZ; i++) {
+      uint32_t x = rnd.next();
+
+      uint64_t region = (i / 100000) % 3;
+      bits[i] = (region == 0 && x % 100 == 0) ||
+          (region == 1 && x % 100 != 0) ||
+          (region == 2 && x % 2 == 0);
+      bv.set_bit(i, bits[i]);
+    }
+
+    snprintf(path, sizeof(path), "/tmp/sbv_paged_test.%d", getpid());
+
+    std::ofstream ofs(path, std::ios::binary);
+    succinct::dense::PagedSuccinctBitVector::write(bv, ofs, 16);
+  }
+
+  virtual void TearDown() {
+    unlink(path);
+  }
+
+  succinct::dense::BitVector bv;
+  std::vector<bool> bits;
+  char path[64];
+};
+
+TEST_F(PagedSuccinctBVTest, rank_and_select) {
+  succinct::dense::PagedSuccinctBitVector pbv(4);
+  pbv.open(path);
+
+  ASSERT_EQ(PAGED_SZ, pbv.length());
+  check_rank_select(pbv, bits);
+  EXPECT_ANY_THROW(pbv.rank(PAGED_SZ, 1));
+  EXPECT_GE(4U, pbv.cached());
+}
+
+TEST_F(PagedSuccinctBVTest, compressed) {
+  std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+  uint64_t fsz = ifs.tellg();
+
+  /* Two thirds of the groups are skewed */
+  EXPECT_GT(PAGED_SZ / 8 * 3 / 4, fsz);
+}
+
+TEST_F(PagedSuccinctBVTest, corrupted) {
+  using succinct::dense::gHeader;
+  using succinct::dense::gEntry;
+
+  succinct::dense::PagedSuccinctBitVector pbv;
+
+  /* An offset in the directory goes backwards */
+  {
+    std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+    gHeader hdr;
+    fs.seekg(-static_cast<int64_t>(sizeof(hdr)), std::ios::end);
+    fs.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+
+    uint64_t off = hdr.dir_off + 2 * sizeof(gEntry);
+    uint64_t v = 1;
+    fs.seekp(off);
+    fs.write(reinterpret_cast<const char *>(&v), sizeof(v));
+  }
+
+  EXPECT_ANY_THROW(pbv.open(path));
+
+  ASSERT_EQ(0, truncate(path, 100));
+  EXPECT_ANY_THROW(pbv.open(path));
+}
+
+TEST_F(PagedSuccinctBVTest, concurrent) {
+  succinct::dense::PagedSuccinctBitVector pbv(2);
+  pbv.open(path);
+
+  std::vector<uint64_t> rk(PAGED_SZ);
+  for (uint64_t i = 0, r = 0; i < PAGED_SZ; i++)
+    rk[i] = (r += bits[i]);
+
+  /* Readers keep missing the small cache, and must not block others */
+  std::vector<std::thread> th;
+  std::vector<int> ok(4, 1);
+  for (size_t t = 0; t < ok.size(); t++) {
+    th.push_back(std::thread([&, t]() {
+      XorShift rnd(88675123 + t);
+      for (size_t n = 0; n < 20000; n++) {
+        uint64_t pos = rnd.next() % PAGED_SZ;
+        if (pbv.lookup(pos) != bits[pos] ||
+            pbv.rank(pos, 1) != rk[pos] ||
+            (bits[pos] && pbv.select(rk[pos] - 1, 1) != pos))
+          ok[t] = 0;
+      }
+    }));
+  }
+
+  for (size_t t = 0; t < th.size(); t++) {
+    th[t].join();
+    EXPECT_TRUE(ok[t]);
+  }
+
+  EXPECT_GE(2U, pbv.cached());
+}
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------
+ *  RLESuccinctBitVector_test.cpp - A unit test for RLESuccinctBitVector.hpp
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "RLESuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t RLE_SZ = 200000;
+
+TEST(RLESuccinctBVTest, runs) {
+  /* Average lengths of runs from short to long */
+  for (uint32_t avg = 1; avg <= 10000; avg *= 10) {
+    succinct::rle::SuccinctBitVector bv;
+    std::vector<bool> bits(RLE_SZ);
+
+    XorShift rnd;
+    uint64_t pos = 0;
+    uint64_t nruns = 0;
+
+    bv.init(RLE_SZ);
+    while (pos < RLE_SZ) {
+      pos += rnd.next() % (2 * avg);
+
+      uint64_t len = std::min<uint64_t>(rnd.next() % (2 * avg) + 1,
+                                        RLE_SZ - pos);
+      if (pos >= RLE_SZ)
+        break;
+
+      bv.add_run(pos, len);
+      for (uint64_t i = pos; i < pos + len; i++)
+        bits[i] = true;
+
+      if (pos == 0 || !bits[pos - 1])
+        nruns++;
+      pos += len;
+    }
+
+    bv.build();
+    ASSERT_EQ(nruns, bv.run_num());
+    check_rank_select(bv, bits);
+  }
+}
+
+TEST(RLESuccinctBVTest, long_runs) {
+  static const uint64_t UNIVERSE = uint64_t(1) << 42;
+
+  succinct::rle::SuccinctBitVector bv;
+  bv.init(UNIVERSE);
+
+  /* 1000 runs of 2^30 ones */
+  for (uint64_t j = 0; j < 1000; j++)
+    bv.add_run(j << 31, uint64_t(1) << 30);
+
+  EXPECT_ANY_THROW(bv.add_run(0, 1));
+  EXPECT_ANY_THROW(bv.add_run(UNIVERSE - 1, 2));
+  bv.build();
+
+  EXPECT_EQ(uint64_t(1000) << 30, bv.get_none());
+  EXPECT_GT(uint64_t(10000), bv.space());
+
+  EXPECT_EQ(uint64_t(7) << 30, bv.rank((uint64_t(7) << 31) - 1, 1));
+  EXPECT_EQ((uint64_t(7) << 31) + 5, bv.select((uint64_t(7) << 30) + 5, 1));
+  EXPECT_EQ((uint64_t(7) << 31) + (uint64_t(1) << 30),
+            bv.select(uint64_t(7) << 30, 0));
+  EXPECT_TRUE(bv.lookup(uint64_t(999) << 31));
+  EXPECT_FALSE(bv.lookup(UNIVERSE - 1));
+
+  /* No ones at all */
+  succinct::rle::SuccinctBitVector zero;
+  zero.init(100);
+  zero.build();
+  EXPECT_EQ(0U, zero.rank(99, 1));
+  EXPECT_EQ(50U, zero.select(50, 0));
+  EXPECT_ANY_THROW(zero.select(0, 1));
+}
+
+TEST(RLESuccinctBVTest, no_runs) {
+  static const uint64_t UNIVERSE = uint64_t(1) << 50;
+
+  /* Space does not depend on length() with no runs */
+  succinct::rle::SuccinctBitVector bv;
+  bv.init(UNIVERSE);
+  bv.build();
+
+  EXPECT_EQ(0U, bv.get_none());
+  EXPECT_GT(uint64_t(1000), bv.space());
+
+  EXPECT_FALSE(bv.lookup(UNIVERSE - 1));
+  EXPECT_EQ(0U, bv.rank(UNIVERSE - 1, 1));
+  EXPECT_EQ(UNIVERSE, bv.rank(UNIVERSE - 1, 0));
+  EXPECT_EQ(UNIVERSE - 1, bv.select(UNIVERSE - 1, 0));
+  EXPECT_ANY_THROW(bv.select(0, 1));
+}
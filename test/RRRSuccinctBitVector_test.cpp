@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------------------------
+ *  RRRSuccinctBitVector_test.cpp - A unit test for RRRSuccinctBitVector.hpp
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "RRRSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t RRR_TEST_SZ = 100000;
+static const size_t RRR_TEST_BSZ[] = {1, 7, 15, 31, 63};
+
+class RRRSuccinctBVTest : public ::testing::Test {
+ public:
+  /* Bits with the density of ones in thres / UINT32_MAX */
+  void init(uint32_t thres, size_t block_sz) {
+    XorShift rnd;
+
+    bits.resize(RRR_TEST_SZ);
+    bv = succinct::rrr::SuccinctBitVector();
+    bv.init(RRR_TEST_SZ, block_sz);
+
+    for (uint64_t i = 0; i < RRR_TEST_SZ; i++) {
+      bits[i] = (rnd.next() < thres);
+      bv.set_bit(i, bits[i]);
+    }
+
+    bv.build();
+  }
+
+  void verify() {
+    check_rank_select(bv, bits);
+    EXPECT_ANY_THROW(bv.rank(RRR_TEST_SZ, 1));
+  }
+
+  succinct::rrr::SuccinctBitVector bv;
+  std::vector<bool> bits;
+};
+
+TEST_F(RRRSuccinctBVTest, dense) {
+  for (size_t i = 0; i < 5; i++) {
+    init(UINT32_MAX / 2, RRR_TEST_BSZ[i]);
+    verify();
+  }
+}
+
+TEST_F(RRRSuccinctBVTest, skewed) {
+  for (size_t i = 0; i < 5; i++) {
+    init(UINT32_MAX / 50, RRR_TEST_BSZ[i]);
+    verify();
+
+    /* Skewed bits are compressed with large blocks */
+    if (RRR_TEST_BSZ[i] >= 31) {
+      EXPECT_GT(RRR_TEST_SZ / 8 / 2, bv.space());
+    }
+
+    init(UINT32_MAX / 50 * 49, RRR_TEST_BSZ[i]);
+    verify();
+  }
+}
+
+TEST_F(RRRSuccinctBVTest, uniform) {
+  for (size_t i = 0; i < 5; i++) {
+    init(0, RRR_TEST_BSZ[i]);
+    verify();
+
+    init(UINT32_MAX, RRR_TEST_BSZ[i]);
+    verify();
+  }
+}
@@ -0,0 +1,93 @@
+/*-----------------------------------------------------------------------------
+ *  ShardedSuccinctBitVector_test.cpp - A unit test for the sharded vector
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "ShardedSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t SHARDED_SZ = 1000000;
+static const size_t SHARDED_SHARD_SZ = 30000;
+
+class ShardedSuccinctBVTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bits.resize(SHARDED_SZ);
+    bv.init(SHARDED_SZ, SHARDED_SHARD_SZ);
+
+    /* Some shards have no ones or no zeros */
+    XorShift rnd(521288629);
+    for (uint64_t i = 0; i < SHARDED_SZ; i++) {
+      uint32_t x = rnd.next();
+
+      uint64_t s = i / SHARDED_SHARD_SZ;
+      bits[i] = (s % 5 == 1) || (s % 5 != 2 && x % 3 == 0);
+      bv.set_bit(i, bits[i]);
+    }
+
+    bv.build(4);
+
+    snprintf(path, sizeof(path), "/tmp/sbv_sharded_test.%d", getpid());
+  }
+
+  virtual void TearDown() {
+    unlink(path);
+  }
+
+  void verify(const succinct::dense::ShardedSuccinctBitVector& sbv) {
+    ASSERT_EQ(SHARDED_SZ, sbv.length());
+    check_rank_select(sbv, bits);
+  }
+
+  void save() {
+    std::ofstream ofs(path, std::ios::binary);
+    bv.save(ofs, false);
+  }
+
+  succinct::dense::ShardedSuccinctBitVector bv;
+  std::vector<bool> bits;
+  char path[64];
+};
+
+TEST_F(ShardedSuccinctBVTest, rank_and_select) {
+  EXPECT_EQ((SHARDED_SZ + SHARDED_SHARD_SZ - 1) / SHARDED_SHARD_SZ,
+            bv.shard_num());
+  verify(bv);
+}
+
+TEST_F(ShardedSuccinctBVTest, lazy_open) {
+  save();
+
+  succinct::dense::ShardedSuccinctBitVector sbv;
+  sbv.open(path);
+  EXPECT_EQ(0U, sbv.loaded());
+
+  /* Global counts come from the prefix table only */
+  EXPECT_EQ(bv.get_none(), sbv.get_none());
+
+  EXPECT_EQ(bv.rank(SHARDED_SHARD_SZ * 3 + 7, 1),
+            sbv.rank(SHARDED_SHARD_SZ * 3 + 7, 1));
+  EXPECT_EQ(1U, sbv.loaded());
+
+  verify(sbv);
+  EXPECT_EQ(sbv.shard_num(), sbv.loaded());
+}
+
+TEST_F(ShardedSuccinctBVTest, eager_open) {
+  save();
+
+  succinct::dense::ShardedSuccinctBitVector sbv;
+  sbv.open(path, false, 4);
+  EXPECT_EQ(sbv.shard_num(), sbv.loaded());
+
+  verify(sbv);
+}
@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------------
+ *  SparseSuccinctBitVector_test.cpp - A unit test for the sparse vector
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "SparseSuccinctBitVector.hpp"
+#include "TestUtil.hpp"
+
+static const size_t SPARSE_SZ = 100000;
+
+TEST(SparseSuccinctBVTest, exhaustive) {
+  /* Densities from no ones to all ones */
+  for (uint32_t d = 0; d <= 8; d++) {
+    uint32_t thres = (d == 8)? UINT32_MAX : d * (UINT32_MAX / 8);
+    XorShift rnd;
+
+    succinct::sparse::SuccinctBitVector bv;
+    std::vector<bool> bits(SPARSE_SZ);
+
+    bv.init(SPARSE_SZ);
+    for (uint64_t i = 0; i < SPARSE_SZ; i++) {
+      bits[i] = (rnd.next() <= thres && thres != 0);
+      if (bits[i])
+        bv.add(i);
+    }
+
+    bv.build();
+
+    uint64_t next[2] = {SPARSE_SZ, SPARSE_SZ};
+
+    for (uint64_t i = SPARSE_SZ; i-- > 0;) {
+      next[bits[i]] = i;
+      ASSERT_EQ(next[0], bv.next(i, 0)) << "Position: " << i;
+      ASSERT_EQ(next[1], bv.next(i, 1)) << "Position: " << i;
+    }
+
+    check_rank_select(bv, bits);
+    EXPECT_EQ(SPARSE_SZ, bv.next(SPARSE_SZ, 1));
+  }
+}
+
+TEST(SparseSuccinctBVTest, huge_universe) {
+  static const uint64_t UNIVERSE = uint64_t(1) << 40;
+
+  succinct::sparse::SuccinctBitVector bv;
+  std::vector<uint64_t> pos;
+
+  uint64_t x = 88172645463325252ULL;
+  uint64_t p = 0;
+  bv.init(UNIVERSE);
+  for (size_t i = 0; i < SPARSE_SZ; i++) {
+    x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+
+    /* Clustered and scattered ones */
+    p += (i % 100 < 10)? 1 : x % (UNIVERSE / SPARSE_SZ);
+    pos.push_back(p);
+    bv.add(p);
+  }
+
+  EXPECT_ANY_THROW(bv.add(p));
+  bv.build();
+
+  ASSERT_EQ(SPARSE_SZ, bv.get_none());
+  EXPECT_GT(SPARSE_SZ * 4, bv.space());
+
+  for (size_t i = 0; i < SPARSE_SZ; i++) {
+    ASSERT_EQ(pos[i], bv.select(i, 1));
+    ASSERT_TRUE(bv.lookup(pos[i]));
+    ASSERT_EQ(i + 1, bv.rank(pos[i], 1));
+    ASSERT_EQ(pos[i], bv.next(pos[i], 1));
+
+    if (pos[i] > 0 && (i == 0 || pos[i - 1] != pos[i] - 1)) {
+      ASSERT_FALSE(bv.lookup(pos[i] - 1));
+      ASSERT_EQ(i, bv.rank(pos[i] - 1, 1));
+      ASSERT_EQ(pos[i] - 1, bv.next(pos[i] - 1, 0));
+      ASSERT_EQ(pos[i] - 1 - i, bv.rank(pos[i] - 1, 0) - 1);
+    }
+  }
+}
+
+TEST(SparseSuccinctBVTest, no_ones) {
+  static const uint64_t UNIVERSE = uint64_t(1) << 40;
+
+  /* The upper bits take a few bits, not the universe */
+  succinct::sparse::SuccinctBitVector bv;
+  bv.init(UNIVERSE);
+  bv.build();
+
+  EXPECT_EQ(0U, bv.get_none());
+  EXPECT_GT(uint64_t(1000), bv.space());
+
+  EXPECT_FALSE(bv.lookup(0));
+  EXPECT_FALSE(bv.lookup(UNIVERSE - 1));
+  EXPECT_EQ(0U, bv.rank(UNIVERSE - 1, 1));
+  EXPECT_EQ(UNIVERSE, bv.rank(UNIVERSE - 1, 0));
+  EXPECT_EQ(UNIVERSE - 1, bv.select(UNIVERSE - 1, 0));
+  EXPECT_EQ(UNIVERSE, bv.next(0, 1));
+  EXPECT_EQ(12345U, bv.next(12345, 0));
+  EXPECT_ANY_THROW(bv.select(0, 1));
+
+  /* Short vectors with no ones */
+  for (uint64_t size = 1; size < 300; size++) {
+    succinct::sparse::SuccinctBitVector s;
+    s.init(size);
+    s.build();
+    for (uint64_t i = 0; i < size; i++) {
+      ASSERT_FALSE(s.lookup(i));
+      ASSERT_EQ(i + 1, s.rank(i, 0));
+      ASSERT_EQ(i, s.select(i, 0));
+    }
+  }
+}
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorExecutor_test.cpp - A unit test for the parallel executor
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "SuccinctBitVectorExecutor.hpp"
+#include "TestUtil.hpp"
+
+static const size_t EXEC_SZ = 1000000;
+static const size_t EXEC_NQUERY = 100000;
+
+class SuccinctBVExecutorTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bv.init(EXEC_SZ);
+
+    XorShift rnd;
+    for (uint64_t i = 0; i < EXEC_SZ; i++) {
+      if (rnd.next() % 3 == 0)
+        bv.set_bit(i, 1);
+    }
+
+    bv.build();
+
+    /* Queries are skewed to the head of the vector */
+    for (size_t i = 0; i < EXEC_NQUERY; i++) {
+      uint32_t x = rnd.next();
+      pos.push_back((i % 2)? x % 1000 : x % EXEC_SZ);
+    }
+  }
+
+  virtual void TearDown() {}
+
+  succinct::dense::SuccinctBitVector bv;
+  std::vector<uint64_t> pos;
+};
+
+TEST_F(SuccinctBVExecutorTest, rank_and_select) {
+  for (int bucket = 0; bucket <= 1; bucket++) {
+    succinct::dense::SuccinctBitVectorExecutor exec(4, bucket);
+    std::vector<uint64_t> out(EXEC_NQUERY);
+
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      exec.parallel_rank(bv, pos.data(), pos.size(), bit, out.data());
+      for (size_t i = 0; i < EXEC_NQUERY; i++)
+        ASSERT_EQ(bv.rank(pos[i], bit), out[i]);
+
+      uint64_t nbits = (bit)? bv.get_none() : EXEC_SZ - bv.get_none();
+      std::vector<uint64_t> spos(pos);
+      for (size_t i = 0; i < EXEC_NQUERY; i++)
+        spos[i] %= nbits;
+
+      exec.parallel_select(bv, spos.data(), spos.size(), bit, out.data());
+      for (size_t i = 0; i < EXEC_NQUERY; i++)
+        ASSERT_EQ(bv.select(spos[i], bit), out[i]);
+    }
+  }
+
+  /* An invalid query is reported to the caller */
+  succinct::dense::SuccinctBitVectorExecutor exec(4);
+  std::vector<uint64_t> out(EXEC_NQUERY);
+  pos[EXEC_NQUERY / 2] = EXEC_SZ;
+  EXPECT_ANY_THROW(exec.parallel_rank(bv, pos.data(), pos.size(), 1,
+                                      out.data()));
+}
+
+TEST_F(SuccinctBVExecutorTest, extract) {
+  std::vector<uint64_t> l(EXEC_NQUERY);
+  std::vector<uint64_t> r(EXEC_NQUERY);
+  for (size_t i = 0; i < EXEC_NQUERY; i++) {
+    l[i] = pos[i];
+    r[i] = std::min(pos[i] + i % 500, uint64_t(EXEC_SZ));
+  }
+
+  succinct::dense::SuccinctBitVectorExecutor exec(4);
+  std::vector<uint64_t> out;
+  std::vector<uint64_t> off;
+  exec.parallel_extract(bv, l.data(), r.data(), l.size(), 1, out, off);
+
+  ASSERT_EQ(EXEC_NQUERY + 1, off.size());
+  for (size_t i = 0; i < EXEC_NQUERY; i++) {
+    std::vector<uint64_t> expected = bv.extract_positions(l[i], r[i], 1);
+    ASSERT_EQ(expected, std::vector<uint64_t>(out.begin() + off[i],
+                                              out.begin() + off[i + 1]));
+  }
+}
@@ -0,0 +1,147 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorLoader_test.cpp - A unit test for the parallel loader
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "SuccinctBitVectorLoader.hpp"
+#include "TestUtil.hpp"
+
+static const size_t LOADER_SZ = 1000000;
+
+class SuccinctBVLoaderTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bits.resize(LOADER_SZ);
+    bv.init(LOADER_SZ);
+
+    XorShift rnd(88675123);
+    for (uint64_t i = 0; i < LOADER_SZ; i++) {
+      bits[i] = (rnd.next() % 5 == 0);
+      bv.set_bit(i, bits[i]);
+    }
+
+    bv.build();
+
+    snprintf(path, sizeof(path), "/tmp/sbv_loader_test.%d", getpid());
+  }
+
+  virtual void TearDown() {
+    unlink(path);
+  }
+
+  void save(bool with_select) {
+    std::ofstream ofs(path, std::ios::binary);
+    bv.save(ofs, with_select);
+  }
+
+  void verify(const succinct::dense::SuccinctBitVector& lbv) {
+    ASSERT_EQ(bv.length(), lbv.length());
+    ASSERT_EQ(bv.stats().nruns, lbv.stats().nruns);
+    check_rank_select(lbv, bits);
+  }
+
+  /* Overwrite a word of the saved file */
+  void patch(uint64_t off, uint64_t v) {
+    std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekp(off);
+    fs.write(reinterpret_cast<const char *>(&v), sizeof(v));
+  }
+
+  uint64_t peek(uint64_t off) {
+    uint64_t v = 0;
+    std::ifstream ifs(path, std::ios::binary);
+    ifs.seekg(off);
+    ifs.read(reinterpret_cast<char *>(&v), sizeof(v));
+    return v;
+  }
+
+  /* Overwrite the j-th entry of the section table with the i-th */
+  void copy_section(uint64_t i, uint64_t j) {
+    uint64_t base = sizeof(succinct::dense::sHeader);
+    uint64_t sz = sizeof(succinct::dense::sSection);
+    for (uint64_t w = 0; w < sz; w += sizeof(uint64_t))
+      patch(base + j * sz + w, peek(base + i * sz + w));
+  }
+
+  succinct::dense::SuccinctBitVector bv;
+  std::vector<bool> bits;
+  char path[64];
+};
+
+TEST_F(SuccinctBVLoaderTest, load) {
+  save(true);
+
+  succinct::dense::SuccinctBitVectorLoader loader(4, 4096);
+  succinct::dense::SuccinctBitVector lbv;
+  loader.load(path, lbv);
+
+  verify(lbv);
+}
+
+TEST_F(SuccinctBVLoaderTest, build_select) {
+  for (int with_select = 0; with_select <= 1; with_select++) {
+    save(with_select);
+
+    succinct::dense::SuccinctBitVectorLoader loader(4, 4096);
+    succinct::dense::SuccinctBitVector lbv;
+    loader.load(path, lbv, true);
+
+    verify(lbv);
+  }
+}
+
+TEST_F(SuccinctBVLoaderTest, truncated) {
+  save(true);
+  ASSERT_EQ(0, truncate(path, 1024));
+
+  succinct::dense::SuccinctBitVectorLoader loader(4, 4096);
+  succinct::dense::SuccinctBitVector lbv;
+  EXPECT_ANY_THROW(loader.load(path, lbv));
+  EXPECT_ANY_THROW(loader.load("/nonexistent/sbv", lbv));
+}
+
+TEST_F(SuccinctBVLoaderTest, corrupted) {
+  using succinct::dense::sHeader;
+  using succinct::dense::sSection;
+
+  succinct::dense::SuccinctBitVectorLoader loader(4, 4096);
+  succinct::dense::SuccinctBitVector lbv;
+
+  /* Every entry is the bits, so the rank is missing */
+  save(true);
+  for (uint64_t i = 1; i < succinct::dense::SEC_NUM; i++)
+    copy_section(0, i);
+  EXPECT_ANY_THROW(loader.load(path, lbv));
+
+  /* The select of zeros appears twice */
+  save(true);
+  copy_section(2, 3);
+  EXPECT_ANY_THROW(loader.load(path, lbv));
+
+  /* A hint points beyond the rBlocks, or goes backwards */
+  save(true);
+  uint64_t sel = peek(sizeof(sHeader) + 3 * sizeof(sSection) +
+                      sizeof(uint64_t));
+  patch(sel + sizeof(uint64_t), LOADER_SZ);
+  EXPECT_ANY_THROW(loader.load(path, lbv));
+
+  save(true);
+  patch(sel + sizeof(uint64_t), peek(sel + 2 * sizeof(uint64_t)) + 1);
+  EXPECT_ANY_THROW(loader.load(path, lbv));
+
+  std::ifstream ifs(path, std::ios::binary);
+  EXPECT_ANY_THROW(lbv.load(ifs));
+
+  /* The hints are not loaded when select is built again */
+  loader.load(path, lbv, true);
+  verify(lbv);
+}
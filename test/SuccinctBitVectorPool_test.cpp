@@ -0,0 +1,54 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorPool_test.cpp - A unit test for SuccinctBitVectorPool.hpp
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include "SuccinctBitVectorPool.hpp"
+#include "TestUtil.hpp"
+
+static const size_t POOL_NVEC = 4096;
+
+class SuccinctBVPoolTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    XorShift rnd;
+
+    for (uint64_t id = 0; id < POOL_NVEC; id++) {
+      uint32_t x = rnd.next();
+
+      /* Lengths and densities vary among vectors */
+      uint64_t len = x % 1000 + 1;
+      uint32_t thres = (id % 8) * (UINT32_MAX / 8);
+
+      pool.add(len);
+      bits.push_back(std::vector<bool>(len));
+
+      for (uint64_t i = 0; i < len; i++) {
+        bits[id][i] = (rnd.next() < thres);
+        pool.set_bit(id, i, bits[id][i]);
+      }
+    }
+
+    pool.build(4);
+  }
+
+  virtual void TearDown() {}
+
+  succinct::dense::SuccinctBitVectorPool pool;
+  std::vector<std::vector<bool> > bits;
+};
+
+TEST_F(SuccinctBVPoolTest, rank_and_select) {
+  typedef IdView<succinct::dense::SuccinctBitVectorPool> View;
+
+  for (uint64_t id = 0; id < POOL_NVEC; id++) {
+    SCOPED_TRACE(id);
+    check_rank_select(View(pool, id), bits[id]);
+  }
+}
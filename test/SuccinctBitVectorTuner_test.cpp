@@ -0,0 +1,144 @@
+/*-----------------------------------------------------------------------------
+ *  SuccinctBitVectorTuner_test.cpp - A unit test for the layout tuner
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "SuccinctBitVectorTuner.hpp"
+#include "TestUtil.hpp"
+
+using succinct::dense::SuccinctBitVector;
+using succinct::dense::SuccinctBitVectorTuner;
+using succinct::dense::dStats;
+using succinct::dense::tChoice;
+
+static const size_t TUNER_SZ = 1000000;
+
+TEST(SuccinctBVTunerTest, stats) {
+  SuccinctBitVector bv;
+  bv.init(TUNER_SZ);
+
+  /* Runs of 10 ones every 100 bits */
+  for (uint64_t i = 0; i < TUNER_SZ; i++) {
+    if (i % 100 < 10)
+      bv.set_bit(i, 1);
+  }
+
+  bv.build();
+  EXPECT_EQ(TUNER_SZ, bv.stats().size);
+  EXPECT_EQ(TUNER_SZ / 10, bv.stats().none);
+  EXPECT_EQ(TUNER_SZ / 100, bv.stats().nruns);
+
+  /* A run crossing the junction is counted once */
+  SuccinctBitVector head;
+  head.init(95);
+  head.set_bit(50, 1);
+  head.set_bit(94, 1);
+  head.build();
+
+  head.append(bv);
+  EXPECT_EQ(TUNER_SZ / 100 + 1, head.stats().nruns);
+  EXPECT_EQ(TUNER_SZ + 95, head.stats().size);
+  EXPECT_EQ(TUNER_SZ / 100, bv.stats().nruns);
+}
+
+TEST(SuccinctBVTunerTest, stats_in_build) {
+  static const uint64_t len = TUNER_SZ + 77;
+
+  SuccinctBitVector bv;
+  bv.init(len);
+
+  /* Runs of random lengths across blocks and rBlocks */
+  uint64_t nruns = 0;
+  XorShift rnd(2463534242U);
+  bool bit = false;
+  for (uint64_t i = 0; i < len;) {
+    uint64_t n = std::min(uint64_t(rnd.next() % 300 + 1), len - i);
+    if (bit) {
+      nruns++;
+      for (uint64_t j = i; j < i + n; j++)
+        bv.set_bit(j, 1);
+    }
+
+    i += n;
+    bit = !bit;
+  }
+
+  bv.build();
+  EXPECT_EQ(len, bv.stats().size);
+  EXPECT_EQ(bv.get_none(), bv.stats().none);
+  EXPECT_EQ(nruns, bv.stats().nruns);
+}
+
+TEST(SuccinctBVTunerTest, tune) {
+  dStats sparse = {TUNER_SZ * 100, 1000, 1000};
+  dStats runs = {TUNER_SZ * 100, TUNER_SZ * 50, 100};
+  dStats random = {TUNER_SZ, TUNER_SZ / 2, TUNER_SZ / 4};
+
+  /* Small budgets go to the encodings for the shapes */
+  tChoice c = SuccinctBitVectorTuner::tune_space(sparse, 0);
+  EXPECT_EQ(succinct::dense::LAYOUT_SPARSE, c.layout);
+  c = SuccinctBitVectorTuner::tune_space(runs, 0);
+  EXPECT_EQ(succinct::dense::LAYOUT_RLE, c.layout);
+
+  /* A large budget goes to the fastest, that is, dense */
+  std::vector<tChoice> all = SuccinctBitVectorTuner::candidates(random);
+  uint64_t cost = all[0].cost;
+  for (size_t i = 0; i < all.size(); i++)
+    cost = std::min(cost, all[i].cost);
+
+  c = SuccinctBitVectorTuner::tune_space(random, TUNER_SZ);
+  EXPECT_EQ(succinct::dense::LAYOUT_DENSE, c.layout);
+  EXPECT_EQ(cost, c.cost);
+
+  /* Choices fit in the budget and the cost */
+  for (size_t i = 0; i < all.size(); i++) {
+    c = SuccinctBitVectorTuner::tune_space(random, all[i].space);
+    EXPECT_GE(all[i].space, c.space);
+    EXPECT_GE(all[i].cost, c.cost);
+
+    c = SuccinctBitVectorTuner::tune_latency(random, all[i].cost);
+    EXPECT_GE(all[i].cost, c.cost);
+    EXPECT_GE(all[i].space, c.space);
+  }
+
+  dStats bad = {0, 0, 0};
+  EXPECT_ANY_THROW(SuccinctBitVectorTuner::candidates(bad));
+}
+
+TEST(SuccinctBVTunerTest, sample) {
+  XorShift rnd;
+  std::vector<bool> bits(TUNER_SZ);
+
+  SuccinctBitVector bv;
+  bv.init(TUNER_SZ);
+  for (uint64_t i = 0; i < TUNER_SZ; i++) {
+    bits[i] = (rnd.next() % 3 == 0);
+    bv.set_bit(i, bits[i]);
+  }
+
+  EXPECT_ANY_THROW(bv.build(0));
+  bv.build();
+
+  tChoice c = SuccinctBitVectorTuner::tune_latency(bv.stats(), 0);
+  ASSERT_EQ(succinct::dense::LAYOUT_DENSE, c.layout);
+  bv.build(c.param);
+  EXPECT_EQ(c.param, bv.select_sample());
+
+  /* The sample is kept in the header */
+  std::stringstream ss;
+  bv.save(ss, false);
+
+  SuccinctBitVector lbv;
+  lbv.load(ss);
+  EXPECT_EQ(c.param, lbv.select_sample());
+  EXPECT_EQ(bv.stats().nruns, lbv.stats().nruns);
+  check_rank_select(lbv, bits);
+}
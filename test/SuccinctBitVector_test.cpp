@@ -9,7 +9,10 @@
  */
 
 #include <gtest/gtest.h>
+#include <sstream>
+
 #include "SuccinctBitVector.hpp"
+#include "TestUtil.hpp"
 
 static const size_t BITV_SZ = 134217728;
 
@@ -62,3 +65,444 @@ TEST_F(SuccinctBVTest, select) {
     }
   }
 }
+
+TEST(SuccinctBVSetBitTest, clear) {
+  static const uint64_t SETBIT_SZ = 10000;
+
+  succinct::dense::SuccinctBitVector sbv;
+  sbv.init(SETBIT_SZ);
+
+  /* Bits set twice and cleared afterwards */
+  for (uint64_t i = 0; i < SETBIT_SZ; i += 3) {
+    sbv.set_bit(i, 1);
+    sbv.set_bit(i, 1);
+  }
+  for (uint64_t i = 0; i < SETBIT_SZ; i += 6)
+    sbv.set_bit(i, 0);
+
+  sbv.build();
+
+  uint64_t nrank1 = 0;
+  for (uint64_t i = 0; i < SETBIT_SZ; i++) {
+    bool bit = i % 3 == 0 && i % 6 != 0;
+    EXPECT_EQ(bit, sbv.lookup(i)) << "Position: " << i;
+
+    if (bit) {
+      EXPECT_EQ(i, sbv.select(nrank1++, 1)) << "Position: " << i;
+    }
+    EXPECT_EQ(nrank1, sbv.rank(i, 1)) << "Position: " << i;
+  }
+
+  EXPECT_ANY_THROW(sbv.select(nrank1, 1));
+}
+
+TEST(SuccinctBVSelectTest, zeros) {
+  static const uint64_t ZEROS_SZ = 10000;
+
+  /* Zeros outnumber ones */
+  succinct::dense::SuccinctBitVector sbv;
+  sbv.init(ZEROS_SZ);
+  for (uint64_t i = 0; i < ZEROS_SZ; i += 10)
+    sbv.set_bit(i, 1);
+
+  sbv.build();
+
+  uint64_t nrank0 = 0;
+  for (uint64_t i = 0; i < ZEROS_SZ; i++) {
+    if (i % 10 != 0) {
+      EXPECT_EQ(i, sbv.select(nrank0++, 0)) << "Position: " << i;
+    }
+  }
+
+  EXPECT_EQ(ZEROS_SZ - ZEROS_SZ / 10, nrank0);
+  EXPECT_ANY_THROW(sbv.select(nrank0, 0));
+  EXPECT_ANY_THROW(sbv.select(ZEROS_SZ / 10, 1));
+}
+
+TEST(SuccinctBVSparseTest, select) {
+  static const uint64_t SPARSE_SZ = 1000000;
+
+  succinct::dense::SuccinctBitVector sbv;
+  sbv.init(SPARSE_SZ);
+
+  /* Many superblocks have no ones or no zeros */
+  for (uint64_t i = 0; i < SPARSE_SZ; i++) {
+    if ((i / 10000) % 2 == 0 && i % 997 == 0)
+      sbv.set_bit(i, 1);
+    if ((i / 10000) % 2 == 1 && i % 991 != 0)
+      sbv.set_bit(i, 1);
+  }
+
+  sbv.build();
+
+  uint64_t nrank0 = 0;
+  uint64_t nrank1 = 0;
+
+  for (uint64_t i = 0; i < SPARSE_SZ; i++) {
+    if (sbv.lookup(i))
+      EXPECT_EQ(i, sbv.select(nrank1++, 1)) << "Position: " << i;
+    else
+      EXPECT_EQ(i, sbv.select(nrank0++, 0)) << "Position: " << i;
+  }
+
+  EXPECT_ANY_THROW(sbv.select(nrank1, 1));
+  EXPECT_ANY_THROW(sbv.select(nrank0, 0));
+}
+
+TEST(SuccinctBVSerializeTest, save_and_load) {
+  static const uint64_t SER_SZ = 100000;
+
+  succinct::dense::SuccinctBitVector sbv;
+  sbv.init(SER_SZ);
+
+  for (uint64_t i = 0; i < SER_SZ; i++) {
+    if (i % 3 == 0 || i % 7 == 0)
+      sbv.set_bit(i, 1);
+  }
+
+  sbv.build();
+
+  for (int with_select = 0; with_select <= 1; with_select++) {
+    std::stringstream ss;
+    sbv.save(ss, with_select);
+
+    succinct::dense::SuccinctBitVector lbv;
+    lbv.load(ss);
+
+    ASSERT_EQ(sbv.length(), lbv.length());
+
+    uint64_t nrank0 = 0;
+    uint64_t nrank1 = 0;
+
+    for (uint64_t i = 0; i < SER_SZ; i++) {
+      EXPECT_EQ(sbv.lookup(i), lbv.lookup(i));
+      EXPECT_EQ(sbv.rank(i, 1), lbv.rank(i, 1));
+
+      if (lbv.lookup(i))
+        EXPECT_EQ(i, lbv.select(nrank1++, 1)) << "Position: " << i;
+      else
+        EXPECT_EQ(i, lbv.select(nrank0++, 0)) << "Position: " << i;
+    }
+  }
+
+  std::stringstream bad("not a bit-vector");
+  succinct::dense::SuccinctBitVector lbv;
+  EXPECT_ANY_THROW(lbv.load(bad));
+}
+
+TEST(SuccinctBVConcatTest, append) {
+  /* Both aligned and unaligned to superblocks */
+  static const uint64_t lens[] = {128, 1000, 64, 3, 256, 77777, 1, 129};
+  static const size_t nparts = sizeof(lens) / sizeof(lens[0]);
+
+  std::vector<bool> bits;
+  std::vector<succinct::dense::SuccinctBitVector> parts(nparts);
+  std::vector<const succinct::dense::SuccinctBitVector *> pptrs;
+
+  XorShift rnd(362436069);
+  for (size_t p = 0; p < nparts; p++) {
+    parts[p].init(lens[p]);
+
+    for (uint64_t i = 0; i < lens[p]; i++) {
+      uint32_t x = rnd.next();
+      bits.push_back((p % 3 == 0)? x % 17 == 0 : x % 2 == 0);
+      parts[p].set_bit(i, bits.back());
+    }
+
+    parts[p].build();
+    pptrs.push_back(&parts[p]);
+  }
+
+  succinct::dense::SuccinctBitVector sbv =
+      succinct::dense::SuccinctBitVector::concat(pptrs);
+
+  ASSERT_EQ(bits.size(), sbv.length());
+  check_rank_select(sbv, bits);
+
+  /* The parts are not changed by sharing dictionaries */
+  EXPECT_EQ(lens[0], parts[0].length());
+  EXPECT_ANY_THROW(parts[0].rank(lens[0], 1));
+
+  /* A vector appended to itself */
+  succinct::dense::SuccinctBitVector dbv = parts[1];
+  dbv.append(dbv);
+
+  ASSERT_EQ(lens[1] * 2, dbv.length());
+  for (uint64_t i = 0; i < lens[1] * 2; i++) {
+    EXPECT_EQ(parts[1].lookup(i % lens[1]), dbv.lookup(i));
+    EXPECT_EQ(parts[1].rank(i % lens[1], 1) +
+              (i / lens[1]) * parts[1].get_none(), dbv.rank(i, 1));
+  }
+}
+
+static const size_t RANDOM_SZ = 200000;
+
+class SuccinctBVRandomTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    bits.resize(RANDOM_SZ);
+    bv.init(RANDOM_SZ);
+
+    /* Regions of random, sparse, empty, full and dense bits */
+    XorShift rnd(88675123);
+    for (uint64_t i = 0; i < RANDOM_SZ; i++) {
+      uint32_t x = rnd.next();
+
+      switch ((i / 5000) % 5) {
+        case 0: bits[i] = (x % 2 == 0); break;
+        case 1: bits[i] = (x % 1000 == 0); break;
+        case 2: bits[i] = false; break;
+        case 3: bits[i] = true; break;
+        case 4: bits[i] = (x % 1000 != 0); break;
+      }
+
+      bv.set_bit(i, bits[i]);
+    }
+
+    bv.build();
+  }
+
+  virtual void TearDown() {}
+
+  succinct::dense::SuccinctBitVector bv;
+  std::vector<bool> bits;
+};
+
+TEST_F(SuccinctBVRandomTest, next_and_prev) {
+  for (uint8_t bit = 0; bit <= 1; bit++) {
+    uint64_t nxt = RANDOM_SZ;
+    for (uint64_t i = RANDOM_SZ; i-- > 0;) {
+      if (bits[i] == bit)
+        nxt = i;
+      ASSERT_EQ(nxt, bv.next(i, bit)) << "Position: " << i;
+    }
+
+    uint64_t prv = RANDOM_SZ;
+    for (uint64_t i = 0; i < RANDOM_SZ; i++) {
+      if (bits[i] == bit)
+        prv = i;
+      ASSERT_EQ(prv, bv.prev(i, bit)) << "Position: " << i;
+    }
+
+    EXPECT_EQ(RANDOM_SZ, bv.next(RANDOM_SZ, bit));
+    EXPECT_ANY_THROW(bv.next(RANDOM_SZ + 1, bit));
+    EXPECT_ANY_THROW(bv.prev(RANDOM_SZ, bit));
+  }
+}
+
+TEST_F(SuccinctBVRandomTest, range) {
+  std::vector<uint64_t> presum(RANDOM_SZ + 1, 0);
+  for (uint64_t i = 0; i < RANDOM_SZ; i++)
+    presum[i + 1] = presum[i] + bits[i];
+
+  XorShift rnd;
+  for (int t = 0; t < 200000; t++) {
+    uint64_t l = rnd.next() % (RANDOM_SZ + 1);
+    uint32_t x = rnd.next();
+
+    /* Both short and long ranges */
+    uint64_t w = (t % 2)? x % 300 : x % RANDOM_SZ;
+    uint64_t r = std::min(l + w, uint64_t(RANDOM_SZ));
+
+    uint64_t c1 = presum[r] - presum[l];
+    uint64_t c0 = (r - l) - c1;
+
+    ASSERT_EQ(c1, bv.count(l, r, 1)) << "Range: " << l << " " << r;
+    ASSERT_EQ(c0, bv.count(l, r, 0)) << "Range: " << l << " " << r;
+    EXPECT_EQ(c1 != 0, bv.any(l, r, 1));
+    EXPECT_EQ(c0 == 0, bv.none(l, r, 0));
+
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      uint64_t c = (bit)? c1 : c0;
+      uint64_t k = (c > 0)? x % (c + 1) : 0;
+
+      uint64_t expected = r;
+      if (k < c)
+        expected = bv.select(((bit)? presum[l] : l - presum[l]) + k, bit);
+
+      ASSERT_EQ(expected, bv.select_in_range(l, r, k, bit))
+          << "Range: " << l << " " << r << " k: " << k;
+    }
+  }
+
+  EXPECT_ANY_THROW(bv.count(2, 1, 1));
+  EXPECT_ANY_THROW(bv.count(0, RANDOM_SZ + 1, 1));
+  EXPECT_EQ(RANDOM_SZ, bv.select_in_range(RANDOM_SZ, RANDOM_SZ, 0, 1));
+}
+
+TEST_F(SuccinctBVRandomTest, extract) {
+  XorShift rnd(521288629);
+  for (int t = 0; t < 2000; t++) {
+    uint64_t l = rnd.next() % (RANDOM_SZ + 1);
+    uint64_t r = std::min(l + rnd.next() % 20000, uint64_t(RANDOM_SZ));
+
+    for (uint8_t bit = 0; bit <= 1; bit++) {
+      std::vector<uint64_t> expected;
+      for (uint64_t i = l; i < r; i++) {
+        if (bits[i] == bit)
+          expected.push_back(i);
+      }
+
+      ASSERT_EQ(expected, bv.extract_positions(l, r, bit))
+          << "Range: " << l << " " << r;
+    }
+  }
+
+  std::vector<uint64_t> all = bv.extract_positions(0, RANDOM_SZ, 1);
+  ASSERT_EQ(bv.get_none(), all.size());
+  for (uint64_t i = 0; i < all.size(); i++)
+    ASSERT_EQ(bv.select(i, 1), all[i]);
+}
+
+TEST_F(SuccinctBVRandomTest, cursor) {
+  for (uint8_t bit = 0; bit <= 1; bit++) {
+    uint64_t nbits = (bit)? bv.get_none() : RANDOM_SZ - bv.get_none();
+
+    /* Sorted streams with short and long gaps */
+    for (uint64_t step = 1; step <= 100000; step *= 7) {
+      succinct::dense::RankCursor rc(bv);
+      for (uint64_t i = 0; i < RANDOM_SZ; i += step)
+        ASSERT_EQ(bv.rank(i, bit), rc.rank(i, bit));
+
+      succinct::dense::SelectCursor sc(bv, bit);
+      for (uint64_t i = 0; i < nbits; i += step)
+        ASSERT_EQ(bv.select(i, bit), sc.select(i));
+    }
+
+    /* Queries out of order */
+    succinct::dense::RankCursor rc(bv);
+    succinct::dense::SelectCursor sc(bv, bit);
+    XorShift rnd(2463534242U);
+    for (int t = 0; t < 10000; t++) {
+      uint32_t x = rnd.next();
+      ASSERT_EQ(bv.rank(x % RANDOM_SZ, bit), rc.rank(x % RANDOM_SZ, bit));
+      ASSERT_EQ(bv.select(x % nbits, bit), sc.select(x % nbits));
+    }
+  }
+}
+
+TEST_F(SuccinctBVRandomTest, select_from) {
+  XorShift rnd(88675123);
+  for (uint8_t bit = 0; bit <= 1; bit++) {
+    uint64_t nbits = (bit)? bv.get_none() : RANDOM_SZ - bv.get_none();
+
+    for (int t = 0; t < 20000; t++) {
+      uint64_t pos = rnd.next() % nbits;
+      uint64_t p = bv.select(pos, bit);
+
+      /* Hints near the result and far from it */
+      int64_t d = static_cast<int64_t>(rnd.next() % 2048) - 1024;
+      if (t % 4 == 0)
+        d *= 100;
+
+      int64_t hint = static_cast<int64_t>(p) + d;
+      hint = std::max<int64_t>(0, std::min<int64_t>(hint, RANDOM_SZ - 1));
+
+      ASSERT_EQ(p, bv.select_from(hint, pos, bit))
+          << "Hint: " << hint << " pos: " << pos;
+    }
+  }
+}
+
+TEST_F(SuccinctBVRandomTest, pattern) {
+  static const char *patterns[] = {"00", "01", "10", "11"};
+
+  EXPECT_ANY_THROW(bv.rank_pattern(0, "10"));
+
+  for (size_t p = 0; p < 4; p++) {
+    const char *pat = patterns[p];
+    bv.build_pattern(pat);
+
+    uint64_t n = 0;
+    for (uint64_t i = 0; i < RANDOM_SZ; i++) {
+      if (i > 0 && bits[i - 1] == (pat[0] == '1') &&
+          bits[i] == (pat[1] == '1')) {
+        ASSERT_EQ(i - 1, bv.select_pattern(n++, pat));
+      }
+
+      ASSERT_EQ(n, bv.rank_pattern(i, pat)) << "Pattern: " << pat;
+    }
+
+    EXPECT_EQ(n, bv.count_pattern(pat));
+    EXPECT_ANY_THROW(bv.select_pattern(n, pat));
+  }
+
+  EXPECT_ANY_THROW(bv.build_pattern("1"));
+  EXPECT_ANY_THROW(bv.build_pattern("1x"));
+
+  /* Patterns straddling the ends of short vectors */
+  for (uint64_t len = 1; len <= 130; len++) {
+    succinct::dense::SuccinctBitVector sbv;
+    sbv.init(len);
+    for (uint64_t i = 0; i < len; i += 2)
+      sbv.set_bit(i, 1);
+
+    sbv.build();
+    sbv.build_pattern("10");
+    sbv.build_pattern("01");
+
+    EXPECT_EQ(len / 2, sbv.count_pattern("10"));
+    EXPECT_EQ((len - 1) / 2, sbv.count_pattern("01"));
+    EXPECT_EQ(len / 2, sbv.rank_pattern(len - 1, "10"));
+  }
+}
+
+TEST_F(SuccinctBVRandomTest, slice) {
+  XorShift rnd(362436069);
+  for (int t = 0; t < 200; t++) {
+    uint64_t l = rnd.next() % RANDOM_SZ;
+    uint64_t r = std::min(l + rnd.next() % 8000, uint64_t(RANDOM_SZ));
+
+    succinct::dense::SuccinctBitVectorSlice s = bv.slice(l, r);
+    ASSERT_EQ(r - l, s.length());
+    ASSERT_EQ(bv.count(l, r, 1), s.get_none());
+
+    SCOPED_TRACE(l);
+    check_rank_select(s, std::vector<bool>(bits.begin() + l,
+                                           bits.begin() + r));
+    EXPECT_ANY_THROW(s.rank(r - l, 1));
+  }
+
+  EXPECT_ANY_THROW(bv.slice(1, 0));
+  EXPECT_ANY_THROW(bv.slice(0, RANDOM_SZ + 1));
+}
+
+TEST_F(SuccinctBVRandomTest, flip_bits) {
+  /* Flips clustered in a few rBlocks and spread over the others */
+  std::vector<uint64_t> pos;
+  XorShift rnd(521288629);
+  for (uint64_t i = 70000; i < RANDOM_SZ; i++) {
+    uint32_t x = rnd.next();
+    if ((i < 70300 && x % 3 == 0) || x % 997 == 0)
+      pos.push_back(i);
+  }
+
+  succinct::dense::SuccinctBitVector fbv = bv;
+  fbv.flip_bits(pos.data(), pos.size());
+  for (size_t i = 0; i < pos.size(); i++)
+    bits[pos[i]] = !bits[pos[i]];
+
+  check_rank_select(fbv, bits);
+  EXPECT_EQ(fbv.get_none(), fbv.stats().none);
+
+  /* The copy does not change bv */
+  EXPECT_NE(fbv.get_none(), bv.get_none());
+  EXPECT_EQ(!bits[pos[0]], bv.lookup(pos[0]));
+
+  /* A slice holds the rank, so flipping back does not change it */
+  uint64_t none = fbv.get_none();
+  succinct::dense::SuccinctBitVectorSlice s = fbv.slice(0, RANDOM_SZ);
+  fbv.flip_bits(pos.data(), pos.size());
+  EXPECT_EQ(none, s.get_none());
+  EXPECT_EQ(bv.get_none(), fbv.get_none());
+  for (size_t i = 0; i < pos.size(); i++) {
+    ASSERT_EQ(bits[pos[i]], s.lookup(pos[i])) << "Position: " << pos[i];
+    ASSERT_EQ(bv.rank(pos[i], 1), fbv.rank(pos[i], 1))
+        << "Position: " << pos[i];
+  }
+
+  uint64_t bad[] = {2, 1};
+  EXPECT_ANY_THROW(fbv.flip_bits(bad, 2));
+  bad[0] = RANDOM_SZ;
+  EXPECT_ANY_THROW(fbv.flip_bits(bad, 1));
+}
@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------------
+ *  TestUtil.hpp - Helpers shared by the unit tests
+ *
+ *  Coding-Style: google-styleguide
+ *      https://code.google.com/p/google-styleguide/
+ *
+ *  Copyright 2012 Takeshi Yamamuro <linguin.m.s_at_gmail.com>
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __TESTUTIL_HPP__
+#define __TESTUTIL_HPP__
+
+#include <gtest/gtest.h>
+#include <cstdint>
+
+/* A xorshift generator, so that every run tests the same bits */
+class XorShift {
+ public:
+  explicit XorShift(uint32_t seed = 123456789) : x_(seed) {}
+
+  uint32_t next() {
+    x_ ^= x_ << 13, x_ ^= x_ >> 17, x_ ^= x_ << 5;
+    return x_;
+  }
+
+ private:
+  uint32_t  x_;
+};
+
+/* A view of the id-th vector in a container of vectors */
+template<class C>
+class IdView {
+ public:
+  IdView(const C& c, uint64_t id) : c_(c), id_(id) {}
+
+  bool lookup(uint64_t pos) const {
+    return c_.lookup(id_, pos);
+  }
+  uint64_t rank(uint64_t pos, uint8_t bit) const {
+    return c_.rank(id_, pos, bit);
+  }
+  uint64_t select(uint64_t r, uint8_t bit) const {
+    return c_.select(id_, r, bit);
+  }
+  uint64_t get_none() const {
+    return c_.get_none(id_);
+  }
+
+ private:
+  const C&  c_;
+  uint64_t  id_;
+};
+
+/*
+ * Check lookup, select and rank of v at every position against
+ * bits, and that select throws beyond the last one and zero. bits
+ * is any container of bits with size() and operator[].
+ */
+template<class V, class B>
+static void check_rank_select(const V& v, const B& bits) {
+  uint64_t nrank0 = 0;
+  uint64_t nrank1 = 0;
+
+  for (uint64_t i = 0; i < bits.size(); i++) {
+    bool bit = bits[i] != 0;
+    ASSERT_EQ(bit, v.lookup(i)) << "Position: " << i;
+
+    if (bit)
+      ASSERT_EQ(i, v.select(nrank1++, 1)) << "Position: " << i;
+    else
+      ASSERT_EQ(i, v.select(nrank0++, 0)) << "Position: " << i;
+
+    ASSERT_EQ(nrank0, v.rank(i, 0)) << "Position: " << i;
+    ASSERT_EQ(nrank1, v.rank(i, 1)) << "Position: " << i;
+  }
+
+  EXPECT_EQ(nrank1, v.get_none());
+  EXPECT_ANY_THROW(v.select(nrank1, 1));
+  EXPECT_ANY_THROW(v.select(nrank0, 0));
+}
+
+#endif /* __TESTUTIL_HPP__ */
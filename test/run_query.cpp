@@ -165,6 +165,20 @@ int main(int argc, char **argv) {
     }
 
     __show_result(stv, nloop, "--select");
+
+    /* A benchmark for next */
+    std::vector<double> ntv;
+
+    for (size_t i = 0; i < NTRIALS; i++) {
+      Timer t;
+
+      for (int j = 0; j < nloop; j++)
+        bv.next((rkwk.get())[j], 1);
+
+      ntv.push_back(t.elapsed());
+    }
+
+    __show_result(ntv, nloop, "--next");
   }
 
   return EXIT_SUCCESS;